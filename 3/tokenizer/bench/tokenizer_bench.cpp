@@ -0,0 +1,357 @@
+// Микробенчмарки токенизатора.
+//
+// Запуск: tokenizer_bench [фильтр] [--quick]
+//   фильтр  - выполнять только тесты, в названии которых есть эта подстрока
+//   --quick - короткие замеры (для быстрой проверки, менее точные)
+//
+// Тексты генерируются из фиксированных списков слов с фиксированным зерном,
+// поэтому входные данные одинаковы от запуска к запуску. Для каждого теста
+// выводится лучшее время итерации и скорость в МБ/с и в элементах/с.
+
+#include "tokenizer.h"
+#include "token_scanner.h"
+#include "char_table.h"
+#include "utf8.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Не дает компилятору выбросить результаты замеряемого кода
+volatile size_t sink = 0;
+
+double min_time_sec = 0.5;
+std::string filter;
+
+const char* const RUSSIAN_WORDS[] = {
+    "Москва", "город", "история", "развитие", "которые", "в", "и", "на",
+    "информационный", "поиск", "документ", "Россия", "году", "после",
+    "человек", "время", "работа", "система", "является", "также",
+    "ко-ко", "Ёлка", "ещё", "был", "для", "что", "по", "с", "не", "из"
+};
+
+const char* const ENGLISH_WORDS[] = {
+    "the", "of", "and", "to", "in", "information", "retrieval", "System",
+    "search", "index", "query", "document", "was", "for", "is", "with",
+    "C++", "AT&T", "o'clock", "3.14", "2024", "London", "first", "by",
+    "processing", "engine", "data", "on", "as", "it"
+};
+
+const char* const SEPARATORS[] = {
+    " ", " ", " ", " ", " ", " ", ", ", ". ", "\n", " - ", "; ", ": ", " (", ") "
+};
+
+enum class Language { Russian, English, Mixed };
+
+const char* language_name(Language language) {
+    switch (language) {
+        case Language::Russian: return "ru";
+        case Language::English: return "en";
+        default: return "mixed";
+    }
+}
+
+template <size_t N>
+const char* pick(const char* const (&words)[N], std::mt19937& rng) {
+    return words[rng() % N];
+}
+
+// Синтетический текст заданного размера (в байтах, с точностью до слова)
+std::string make_text(Language language, size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string text;
+    text.reserve(size + 64);
+    while (text.size() < size) {
+        bool russian = language == Language::Russian ||
+                       (language == Language::Mixed && rng() % 2 == 0);
+        text += russian ? pick(RUSSIAN_WORDS, rng) : pick(ENGLISH_WORDS, rng);
+        text += pick(SEPARATORS, rng);
+    }
+    return text;
+}
+
+// Текст с большим словарем: случайные "слова" из латиницы и кириллицы
+std::string make_vocabulary_text(size_t words, uint32_t seed) {
+    static const char* const SYLLABLES[] = {
+        "ка", "ро", "ми", "ст", "ве", "на", "по", "ли",
+        "ta", "re", "on", "si", "mu", "ex", "al", "in"
+    };
+    std::mt19937 rng(seed);
+    std::string text;
+    for (size_t i = 0; i < words; i++) {
+        size_t syllables = 2 + rng() % 4;
+        for (size_t j = 0; j < syllables; j++) {
+            text += pick(SYLLABLES, rng);
+        }
+        text += ' ';
+    }
+    return text;
+}
+
+std::string size_name(size_t size) {
+    if (size >= 1024 * 1024) {
+        return std::to_string(size / (1024 * 1024)) + "MB";
+    }
+    return std::to_string(size / 1024) + "KB";
+}
+
+// Лучшее время одного вызова: прогревочный вызов, затем повторы,
+// пока суммарное время не превысит min_time_sec (не меньше трех повторов)
+template <typename Function>
+double measure(Function&& function) {
+    function();
+    double best = 1e100;
+    double total = 0.0;
+    size_t runs = 0;
+    while (total < min_time_sec || runs < 3) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        best = std::min(best, elapsed);
+        total += elapsed;
+        runs++;
+    }
+    return best;
+}
+
+bool selected(const std::string& name) {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+// Дополняет строку пробелами до width символов (std::setw считает байты,
+// а названия колонок - кириллица в UTF-8)
+std::string pad(const std::string& text, size_t width, bool left_align) {
+    size_t chars = 0;
+    for (unsigned char c : text) {
+        chars += (c & 0xC0) != 0x80;
+    }
+    std::string padding(chars < width ? width - chars : 0, ' ');
+    return left_align ? text + padding : padding + text;
+}
+
+std::string format(double value, int precision) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+void print_header() {
+    std::cout << pad("Тест", 44, true) << pad("мкс/итер", 14, false)
+              << pad("МБ/с", 12, false) << pad("млн/с", 12, false)
+              << "  элементы" << std::endl;
+    std::cout << std::string(92, '-') << std::endl;
+}
+
+// bytes и items - объем работы за одну итерацию (bytes = 0 - не применимо)
+void report(const std::string& name, double seconds, size_t bytes,
+            size_t items, const char* unit) {
+    std::string speed = bytes > 0 ? format(bytes / seconds / (1024 * 1024), 1) : "-";
+    std::cout << pad(name, 44, true) << pad(format(seconds * 1e6, 1), 14, false)
+              << pad(speed, 12, false) << pad(format(items / seconds / 1e6, 2), 12, false)
+              << "  " << unit << std::endl;
+}
+
+size_t count_tokens(std::string_view text) {
+    size_t count = 0;
+    Tokenizer::for_each_token(text, [&](std::string_view) { count++; });
+    return count;
+}
+
+void bench_process_text() {
+    const Language languages[] = {Language::Russian, Language::English, Language::Mixed};
+    const size_t sizes[] = {1024, 10 * 1024, 100 * 1024, 10 * 1024 * 1024};
+
+    for (Language language : languages) {
+        for (size_t size : sizes) {
+            std::string name = std::string("process_text/") + language_name(language) +
+                               "/" + size_name(size);
+            if (!selected(name)) {
+                continue;
+            }
+            std::string text = make_text(language, size, 42);
+            size_t tokens = count_tokens(text);
+
+            // Режим Streaming: после первого прохода словарь уже заполнен,
+            // и замеряется установившаяся скорость без роста памяти
+            Tokenizer tokenizer(Tokenizer::Mode::Streaming);
+            double seconds = measure([&] { tokenizer.process_text(text); });
+            sink = sink + tokenizer.get_token_count();
+            report(name, seconds, text.size(), tokens, "токенов");
+        }
+    }
+}
+
+void bench_scanner() {
+    const Language languages[] = {Language::Russian, Language::English, Language::Mixed};
+
+    for (Language language : languages) {
+        std::string name = std::string("token_scanner/") + language_name(language) + "/1MB";
+        if (!selected(name)) {
+            continue;
+        }
+        std::string text = make_text(language, 1024 * 1024, 42);
+        size_t tokens = count_tokens(text);
+
+        // Только разбор на токены, без словаря
+        double seconds = measure([&] {
+            size_t bytes = 0;
+            Tokenizer::for_each_token(text, [&](std::string_view token) { bytes += token.size(); });
+            sink = sink + bytes;
+        });
+        report(name, seconds, text.size(), tokens, "токенов");
+    }
+}
+
+void bench_char_table() {
+    std::string text = make_text(Language::Mixed, 1024 * 1024, 7);
+
+    std::vector<char32_t> chars;
+    for (size_t pos = 0; pos < text.size();) {
+        chars.push_back(utf8::decode(text.data(), text.size(), pos));
+    }
+
+    if (selected("char_table/is_letter_or_digit")) {
+        double seconds = measure([&] {
+            size_t n = 0;
+            for (char32_t c : chars) {
+                n += char_table::is_letter_or_digit(c);
+            }
+            sink = sink + n;
+        });
+        report("char_table/is_letter_or_digit", seconds, text.size(), chars.size(), "символов");
+    }
+
+    if (selected("char_table/is_digit")) {
+        double seconds = measure([&] {
+            size_t n = 0;
+            for (char32_t c : chars) {
+                n += char_table::is_digit(c);
+            }
+            sink = sink + n;
+        });
+        report("char_table/is_digit", seconds, text.size(), chars.size(), "символов");
+    }
+
+    if (selected("char_table/to_lower")) {
+        double seconds = measure([&] {
+            size_t n = 0;
+            for (char32_t c : chars) {
+                n += char_table::to_lower(c);
+            }
+            sink = sink + n;
+        });
+        report("char_table/to_lower", seconds, text.size(), chars.size(), "символов");
+    }
+
+    if (selected("char_table/utf8_decode")) {
+        double seconds = measure([&] {
+            size_t n = 0;
+            for (size_t pos = 0; pos < text.size();) {
+                n += utf8::decode(text.data(), text.size(), pos);
+            }
+            sink = sink + n;
+        });
+        report("char_table/utf8_decode", seconds, text.size(), chars.size(), "символов");
+    }
+
+    if (selected("char_table/skip_and_scan_run")) {
+        // Пакетная классификация: пропуск разделителей и серий букв,
+        // прочие символы пропускаются по одному
+        double seconds = measure([&] {
+            size_t pos = 0;
+            size_t count = 0;
+            char32_t last = 0;
+            bool needs_fold = false;
+            while (pos < text.size()) {
+                pos = char_table::skip_delimiters(text.data(), pos, text.size());
+                size_t run_end = char_table::scan_run(text.data(), pos, text.size(),
+                                                      count, last, needs_fold);
+                if (run_end == pos && pos < text.size()) {
+                    utf8::decode(text.data(), text.size(), run_end);
+                }
+                pos = run_end;
+            }
+            sink = sink + count + last + needs_fold;
+        });
+        report("char_table/skip_and_scan_run", seconds, text.size(), chars.size(), "символов");
+    }
+
+    if (selected("char_table/append_lower")) {
+        std::string out;
+        double seconds = measure([&] {
+            out.clear();
+            char_table::append_lower(out, text.data(), text.size());
+            sink = sink + out.size();
+        });
+        report("char_table/append_lower", seconds, text.size(), chars.size(), "символов");
+    }
+}
+
+void bench_top_tokens() {
+    const size_t vocabulary_words[] = {100000, 1000000};
+    const size_t top_sizes[] = {10, 1000};
+
+    for (size_t words : vocabulary_words) {
+        std::string text;
+        Tokenizer tokenizer(Tokenizer::Mode::Streaming);
+        Tokenizer approximate(Tokenizer::Mode::Approximate);
+        bool built = false;
+
+        for (size_t n : top_sizes) {
+            std::string suffix = "/" + std::to_string(words / 1000) + "k_words/top" + std::to_string(n);
+            std::string exact_name = "get_top_tokens" + suffix;
+            std::string approximate_name = "get_top_tokens_approx" + suffix;
+            if (!selected(exact_name) && !selected(approximate_name)) {
+                continue;
+            }
+            if (!built) {
+                text = make_vocabulary_text(words, 11);
+                tokenizer.process_text(text);
+                approximate.process_text(text);
+                built = true;
+            }
+
+            if (selected(exact_name)) {
+                // Элементы - термы словаря, которые просматривает отбор
+                size_t terms = tokenizer.get_unique_token_count();
+                double seconds = measure([&] { sink = sink + tokenizer.get_top_tokens(n).size(); });
+                report(exact_name, seconds, 0, terms, "термов");
+            }
+            if (selected(approximate_name)) {
+                size_t terms = std::min<size_t>(4096, tokenizer.get_unique_token_count());
+                double seconds = measure([&] { sink = sink + approximate.get_top_tokens(n).size(); });
+                report(approximate_name, seconds, 0, terms, "термов");
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            min_time_sec = 0.05;
+        } else {
+            filter = arg;
+        }
+    }
+
+    print_header();
+    bench_process_text();
+    bench_scanner();
+    bench_char_table();
+    bench_top_tokens();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "char_table.h"
+#include "utf8.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHAR_TABLE_AVX2 1
+#define CHAR_TABLE_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHAR_TABLE_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace char_table {
+
+namespace {
+
+constexpr Tables build_tables() {
+    Tables t{};
+
+    auto set = [&t](char32_t c, uint8_t cls, char32_t lower) {
+        t.char_class[c] = cls | CLASS_KNOWN;
+        t.lower[c] = lower;
+    };
+
+    // По умолчанию: ASCII и Latin-1 - не буквы, регистр не меняется
+    for (char32_t c = 0; c < 0x100; c++) {
+        set(c, 0, c);
+    }
+
+    // Цифры и латиница ASCII
+    for (char32_t c = U'0'; c <= U'9'; c++) {
+        set(c, CLASS_DIGIT, c);
+    }
+    for (char32_t c = U'a'; c <= U'z'; c++) {
+        set(c, CLASS_LETTER, c);
+        set(c - 0x20, CLASS_LETTER, c);
+    }
+
+    // Latin-1: À..Þ (кроме ×) -> à..þ, а также ß, ÿ, ª, µ, º
+    for (char32_t c = 0xC0; c <= 0xDE; c++) {
+        if (c != 0xD7) {
+            set(c, CLASS_LETTER, c + 0x20);
+            set(c + 0x20, CLASS_LETTER, c + 0x20);
+        }
+    }
+    set(0xDF, CLASS_LETTER, 0xDF);
+    set(0xFF, CLASS_LETTER, 0xFF);
+    set(0xAA, CLASS_LETTER, 0xAA);
+    set(0xB5, CLASS_LETTER, 0xB5);
+    set(0xBA, CLASS_LETTER, 0xBA);
+
+    // Кириллица: Ѐ..Џ -> ѐ..џ, А..Я -> а..я
+    for (char32_t c = 0x400; c < 0x410; c++) {
+        set(c, CLASS_LETTER, c + 0x50);
+        set(c + 0x50, CLASS_LETTER, c + 0x50);
+    }
+    for (char32_t c = 0x410; c < 0x430; c++) {
+        set(c, CLASS_LETTER, c + 0x20);
+        set(c + 0x20, CLASS_LETTER, c + 0x20);
+    }
+
+    // Расширенная кириллица: пары "заглавная (чётная) - строчная (нечётная)"
+    for (char32_t c = 0x460; c < 0x500; c += 2) {
+        set(c, CLASS_LETTER, c + 1);
+        set(c + 1, CLASS_LETTER, c + 1);
+    }
+    // Знак тысяч и комбинируемые знаки - не буквы
+    for (char32_t c = 0x482; c < 0x48A; c++) {
+        set(c, 0, c);
+    }
+    // Ӏ и пары Ӂ..ӎ сдвинуты на единицу
+    set(0x4C0, CLASS_LETTER, 0x4CF);
+    for (char32_t c = 0x4C1; c < 0x4CF; c += 2) {
+        set(c, CLASS_LETTER, c + 1);
+        set(c + 1, CLASS_LETTER, c + 1);
+    }
+    set(0x4CF, CLASS_LETTER, 0x4CF);
+
+    return t;
+}
+
+constexpr Tables TABLES = build_tables();
+
+static_assert(TABLES.lower[U'A'] == U'a' && TABLES.lower[U'z'] == U'z', "ASCII");
+static_assert(TABLES.char_class[U'7'] == (CLASS_DIGIT | CLASS_KNOWN), "digits");
+static_assert(TABLES.lower[U'-'] == U'-' && TABLES.char_class[U'-'] == CLASS_KNOWN, "punctuation");
+static_assert(TABLES.lower[U'Ё'] == U'ё' && TABLES.lower[U'Я'] == U'я', "Cyrillic");
+static_assert(TABLES.lower[U'А'] == U'а' && TABLES.lower[U'ё'] == U'ё', "Cyrillic");
+static_assert(TABLES.lower[U'Ӂ'] == U'ӂ' && TABLES.lower[U'Ӏ'] == U'ӏ', "Extended Cyrillic");
+static_assert(TABLES.char_class[0xD7] == CLASS_KNOWN, "multiplication sign");
+
+inline bool is_ascii_alnum(unsigned char b) {
+    return b < 0x80 && (tables.char_class[b] & (CLASS_LETTER | CLASS_DIGIT)) != 0;
+}
+
+inline unsigned count_trailing_zeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+#ifdef CHAR_TABLE_SSE2
+
+// Маска байтов - букв и цифр ASCII. Байты >= 0x80 при знаковом
+// сравнении отрицательны и в диапазоны не попадают.
+inline __m128i ascii_alnum_mask(__m128i v) {
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i lv = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lv, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lv, _mm_set1_epi8('z' + 1)));
+    return _mm_or_si128(digit, letter);
+}
+
+inline __m128i ascii_upper_mask(__m128i v) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+}
+
+inline __m128i ascii_to_lower(__m128i v) {
+    return _mm_add_epi8(v, _mm_and_si128(ascii_upper_mask(v), _mm_set1_epi8(0x20)));
+}
+
+// Смещение символа от U+0400 для каждой пары байтов: ((lead & 1) << 6) | (cont & 0x3F)
+inline __m128i cyrillic_offsets(__m128i v) {
+    __m128i lead = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+    __m128i cont = _mm_srli_epi16(v, 8);
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(1)), 6),
+                        _mm_and_si128(cont, _mm_set1_epi16(0x3F)));
+}
+
+// Маска пар байтов, являющихся кириллическими буквами U+0400..U+045F
+inline __m128i cyrillic_letter_mask(__m128i v, __m128i u) {
+    __m128i lead = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+    __m128i cont = _mm_srli_epi16(v, 8);
+    __m128i lead_ok = _mm_cmpeq_epi16(_mm_and_si128(lead, _mm_set1_epi16(0xFE)),
+                                      _mm_set1_epi16(0xD0));
+    __m128i cont_ok = _mm_cmpeq_epi16(_mm_and_si128(cont, _mm_set1_epi16(0xC0)),
+                                      _mm_set1_epi16(0x80));
+    __m128i letter = _mm_cmplt_epi16(u, _mm_set1_epi16(0x60));
+    return _mm_and_si128(_mm_and_si128(lead_ok, cont_ok), letter);
+}
+
+// Заглавные: Ѐ..Я (смещение < 0x30)
+inline __m128i cyrillic_upper_mask(__m128i u) {
+    return _mm_cmplt_epi16(u, _mm_set1_epi16(0x30));
+}
+
+// Приводит восемь кириллических букв к нижнему регистру: Ѐ..Џ +0x50, А..Я +0x20
+inline __m128i cyrillic_to_lower(__m128i u) {
+    __m128i lt10 = _mm_cmplt_epi16(u, _mm_set1_epi16(0x10));
+    __m128i lt30 = cyrillic_upper_mask(u);
+    __m128i add = _mm_or_si128(_mm_and_si128(lt10, _mm_set1_epi16(0x50)),
+                               _mm_andnot_si128(lt10, _mm_and_si128(lt30, _mm_set1_epi16(0x20))));
+    u = _mm_add_epi16(u, add);
+
+    __m128i new_lead = _mm_or_si128(_mm_set1_epi16(0xD0), _mm_srli_epi16(u, 6));
+    __m128i new_cont = _mm_or_si128(_mm_set1_epi16(0x80), _mm_and_si128(u, _mm_set1_epi16(0x3F)));
+    return _mm_or_si128(new_lead, _mm_slli_epi16(new_cont, 8));
+}
+
+#endif
+
+#ifdef CHAR_TABLE_AVX2
+
+inline __m256i ascii_alnum_mask(__m256i v) {
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i lv = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lv, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lv));
+    return _mm256_or_si256(digit, letter);
+}
+
+inline __m256i ascii_upper_mask(__m256i v) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+}
+
+#endif
+
+// Кириллическая буква U+0400..U+045F в виде двух байтов UTF-8
+inline bool is_cyrillic_pair(unsigned char b0, unsigned char b1) {
+    return (b0 == 0xD0 && (b1 & 0xC0) == 0x80) ||
+           (b0 == 0xD1 && b1 >= 0x80 && b1 <= 0x9F);
+}
+
+} // namespace
+
+const Tables tables = TABLES;
+
+size_t skip_delimiters(const char* data, size_t pos, size_t len) {
+#ifdef CHAR_TABLE_AVX2
+    while (pos + 32 <= len) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(ascii_alnum_mask(v), v)));
+        if (mask != 0) {
+            return pos + count_trailing_zeros(mask);
+        }
+        pos += 32;
+    }
+#endif
+#ifdef CHAR_TABLE_SSE2
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(ascii_alnum_mask(v), v)));
+        if (mask != 0) {
+            return pos + count_trailing_zeros(mask);
+        }
+        pos += 16;
+    }
+#endif
+    while (pos < len) {
+        unsigned char b = static_cast<unsigned char>(data[pos]);
+        if (b >= 0x80 || is_ascii_alnum(b)) {
+            break;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+size_t scan_run(const char* data, size_t pos, size_t len,
+                size_t& chars, char32_t& last, bool& needs_fold) {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+
+    while (pos < len) {
+        unsigned char b0 = s[pos];
+
+        if (b0 < 0x80) {
+            if (!is_ascii_alnum(b0)) {
+                break;
+            }
+            // Серия ASCII: классифицируем векторно
+#ifdef CHAR_TABLE_AVX2
+            while (pos + 32 <= len) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(ascii_alnum_mask(v)));
+                size_t n = (mask == 0xFFFFFFFFu) ? 32 : count_trailing_zeros(~mask);
+                if (n == 0) {
+                    break;
+                }
+                unsigned upper = static_cast<unsigned>(_mm256_movemask_epi8(ascii_upper_mask(v)));
+                if (n < 32) {
+                    upper &= (1u << n) - 1;
+                }
+                needs_fold |= upper != 0;
+                chars += n;
+                pos += n;
+                last = tables.lower[s[pos - 1]];
+                if (n < 32) {
+                    break;
+                }
+            }
+#endif
+#ifdef CHAR_TABLE_SSE2
+            while (pos + 16 <= len) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ascii_alnum_mask(v)));
+                size_t n = (mask == 0xFFFF) ? 16 : count_trailing_zeros(~mask);
+                if (n == 0) {
+                    break;
+                }
+                unsigned upper = static_cast<unsigned>(_mm_movemask_epi8(ascii_upper_mask(v)));
+                needs_fold |= (upper & ((1u << n) - 1)) != 0;
+                chars += n;
+                pos += n;
+                last = tables.lower[s[pos - 1]];
+                if (n < 16) {
+                    break;
+                }
+            }
+#endif
+            // Скалярный хвост
+            while (pos < len && is_ascii_alnum(s[pos])) {
+                char32_t c = tables.lower[s[pos]];
+                needs_fold |= c != s[pos];
+                chars++;
+                pos++;
+                last = c;
+            }
+            continue;
+        }
+
+        if (pos + 1 >= len || !is_cyrillic_pair(b0, s[pos + 1])) {
+            break;
+        }
+
+        // Серия кириллицы: по восемь символов за раз
+#ifdef CHAR_TABLE_SSE2
+        while (pos + 16 <= len) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i u = cyrillic_offsets(v);
+            __m128i ok = cyrillic_letter_mask(v, u);
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ok));
+            size_t n = (mask == 0xFFFF) ? 16 : count_trailing_zeros(~mask);
+            if (n == 0) {
+                break;
+            }
+            unsigned upper = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(ok, cyrillic_upper_mask(u))));
+            needs_fold |= (upper & ((1u << n) - 1)) != 0;
+            chars += n / 2;
+            pos += n;
+            last = tables.lower[0x400 | ((s[pos - 2] & 1) << 6) | (s[pos - 1] & 0x3F)];
+            if (n < 16) {
+                break;
+            }
+        }
+#endif
+        // Скалярный хвост
+        while (pos + 1 < len && is_cyrillic_pair(s[pos], s[pos + 1])) {
+            char32_t c = 0x400 | ((s[pos] & 1) << 6) | (s[pos + 1] & 0x3F);
+            char32_t lower = tables.lower[c];
+            needs_fold |= lower != c;
+            chars++;
+            pos += 2;
+            last = lower;
+        }
+    }
+
+    return pos;
+}
+
+void append_lower(std::string& out, const char* data, size_t len) {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+    size_t pos = 0;
+
+    while (pos < len) {
+#ifdef CHAR_TABLE_SSE2
+        // Блок из 16 байтов ASCII или 8 кириллических букв - векторно
+        if (pos + 16 <= len) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            char buf[16];
+            if (_mm_movemask_epi8(v) == 0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(buf), ascii_to_lower(v));
+                out.append(buf, 16);
+                pos += 16;
+                continue;
+            }
+            __m128i u = cyrillic_offsets(v);
+            if (_mm_movemask_epi8(cyrillic_letter_mask(v, u)) == 0xFFFF) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(buf), cyrillic_to_lower(u));
+                out.append(buf, 16);
+                pos += 16;
+                continue;
+            }
+        }
+#endif
+        unsigned char b0 = s[pos];
+        if (b0 < 0x80) {
+            out += static_cast<char>(tables.lower[b0]);
+            pos++;
+        } else if (pos + 1 < len && is_cyrillic_pair(b0, s[pos + 1])) {
+            char32_t c = tables.lower[0x400 | ((b0 & 1) << 6) | (s[pos + 1] & 0x3F)];
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+            pos += 2;
+        } else {
+            utf8::append(out, to_lower(utf8::decode(data, len, pos)));
+        }
+    }
+}
+
+} // namespace char_table
\ No newline at end of file
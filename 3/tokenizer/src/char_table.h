@@ -0,0 +1,65 @@
+#ifndef CHAR_TABLE_H
+#define CHAR_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <cwctype>
+
+// Предвычисленная классификация символов и приведение к нижнему регистру
+// для латиницы (ASCII + Latin-1), кириллицы (U+0400..U+04FF) и цифр.
+// Символы вне таблицы обрабатываются функциями из cwctype.
+namespace char_table {
+
+constexpr char32_t TABLE_SIZE = 0x500;
+
+enum : uint8_t {
+    CLASS_LETTER = 1,
+    CLASS_DIGIT  = 2,
+    CLASS_KNOWN  = 4   // Символ описан таблицей (иначе - запасной путь)
+};
+
+struct Tables {
+    uint8_t char_class[TABLE_SIZE];
+    char32_t lower[TABLE_SIZE];
+};
+
+extern const Tables tables;
+
+inline bool is_letter_or_digit(char32_t c) {
+    if (c < TABLE_SIZE && (tables.char_class[c] & CLASS_KNOWN)) {
+        return (tables.char_class[c] & (CLASS_LETTER | CLASS_DIGIT)) != 0;
+    }
+    return iswalnum(static_cast<wint_t>(c)) != 0;
+}
+
+inline bool is_digit(char32_t c) {
+    return c >= U'0' && c <= U'9';
+}
+
+inline char32_t to_lower(char32_t c) {
+    if (c < TABLE_SIZE && (tables.char_class[c] & CLASS_KNOWN)) {
+        return tables.lower[c];
+    }
+    return static_cast<char32_t>(towlower(static_cast<wint_t>(c)));
+}
+
+// Возвращает позицию первого байта, начиная с pos, который может начинать
+// токен (буква/цифра ASCII или любой не-ASCII байт). Вне токена все
+// остальные ASCII-символы - разделители, поэтому их можно пропускать пачкой.
+size_t skip_delimiters(const char* data, size_t pos, size_t len);
+
+// Находит конец максимальной серии букв и цифр ASCII и двухбайтовых
+// кириллических букв (U+0400..U+045F), начиная с pos, ничего не копируя.
+// Возвращает позицию после серии; chars увеличивается на число символов,
+// last получает последний символ серии (в нижнем регистре),
+// needs_fold выставляется, если в серии есть заглавные буквы.
+size_t scan_run(const char* data, size_t pos, size_t len,
+                size_t& chars, char32_t& last, bool& needs_fold);
+
+// Дописывает в out текст токена (корректный UTF-8) в нижнем регистре
+void append_lower(std::string& out, const char* data, size_t len);
+
+} // namespace char_table
+
+#endif
\ No newline at end of file
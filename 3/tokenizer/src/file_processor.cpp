@@ -1,13 +1,39 @@
 #include "file_processor.h"
 #include "tokenizer.h"
+#include "mapped_file.h"
 #include <iostream>
 #include <filesystem>
 #include <chrono>
-#include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace fs = std::filesystem;
 
+namespace {
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point from,
+                    std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+volatile unsigned char page_sink;
+
+// Подкачивает страницы отображения (читает по байту со страницы), чтобы
+// время ввода-вывода попало в этап read, а не размазалось по разбору
+void touch_pages(std::string_view data) {
+    const size_t PAGE_SIZE = 4096;
+    unsigned char sum = 0;
+    for (size_t i = 0; i < data.size(); i += PAGE_SIZE) {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+    page_sink = sum;
+}
+
+} // namespace
+
 void FileProcessor::scan_directory(const std::string& path) {
     files.clear();
     
@@ -27,36 +53,92 @@ void FileProcessor::scan_directory(const std::string& path) {
 void FileProcessor::process_files(Tokenizer& tokenizer,
                                  size_t& total_tokens,
                                  double& total_time,
-                                 size_t& total_bytes) {
+                                 size_t& total_bytes,
+                                 size_t num_threads) {
     total_tokens = 0;
     total_time = 0.0;
     total_bytes = 0;
-    processing_timings.clear();
+    profile.clear();
+    
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    num_threads = std::min(num_threads, std::max<size_t>(files.size(), 1));
     
     auto start_total = std::chrono::high_resolution_clock::now();
     
-    for (size_t i = 0; i < files.size(); i++) {
-        if (i % 100 == 0) {
-            std::cout << "\rОбработка файла " << i+1 << " из " << files.size()
-                      << " (" << (i*100/files.size()) << "%)" << std::flush;
+    // Поток 0 пишет прямо в tokenizer, остальные - в свои токенизаторы
+    // с тем же режимом, размером выборки и емкостью Space-Saving.
+    // Профили задержек и счетчики байт у каждого потока свои
+    std::vector<Tokenizer> local_tokenizers;
+    for (size_t t = 1; t < num_threads; t++) {
+        local_tokenizers.emplace_back(tokenizer.get_mode(), tokenizer.get_sample_size(),
+                                      tokenizer.get_top_capacity());
+    }
+    std::vector<StageProfile> local_profiles(num_threads);
+    std::vector<size_t> local_bytes(num_threads, 0);
+    
+    std::atomic<size_t> next_file(0);
+    std::mutex progress_mutex;
+    
+    auto worker = [&](Tokenizer& local, size_t thread_index) {
+        StageProfile& local_profile = local_profiles[thread_index];
+        for (;;) {
+            size_t i = next_file.fetch_add(1, std::memory_order_relaxed);
+            if (i >= files.size()) {
+                break;
+            }
+            
+            if (i % 100 == 0) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                std::cout << "\rОбработка файла " << i+1 << " из " << files.size()
+                          << " (" << (i*100/files.size()) << "%)" << std::flush;
+            }
+            
+            // Этапы: чтение (отображение и подкачка), разбор, подсчет
+            auto start = std::chrono::steady_clock::now();
+            MappedFile file;
+            if (!file.open(files[i])) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                std::cerr << "Ошибка открытия файла: " << files[i] << std::endl;
+                continue;
+            }
+            touch_pages(file.view());
+            auto read = std::chrono::steady_clock::now();
+            
+            Tokenizer::StageTimes times;
+            local.process_text(file.view(), times);
+            auto end = std::chrono::steady_clock::now();
+            
+            size_t file_size = file.get_size();
+            local_bytes[thread_index] += file_size;
+            local_profile.record(StageProfile::READ, file_size, elapsed_ns(start, read));
+            local_profile.record(StageProfile::TOKENIZE, file_size, times.tokenize_ns);
+            local_profile.record(StageProfile::COUNT, file_size, times.count_ns);
+            local_profile.record(StageProfile::TOTAL, file_size, elapsed_ns(start, end));
         }
-        
-        // Читаем размер файла
-        std::ifstream file(files[i], std::ios::binary | std::ios::ate);
-        size_t file_size = file.tellg();
-        file.close();
-        total_bytes += file_size;
-        
-        // Обработка файла с замером времени
-        auto start = std::chrono::high_resolution_clock::now();
-        tokenizer.process_file(files[i]);
-        auto end = std::chrono::high_resolution_clock::now();
-        
-        double file_time = std::chrono::duration<double>(end - start).count();
-        processing_timings.push_back({file_size, file_time});
-        total_time += file_time;
-        total_tokens = tokenizer.get_token_count();
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        threads.emplace_back(worker, std::ref(local_tokenizers[t - 1]), t);
+    }
+    worker(tokenizer, 0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // Слияние результатов потоков (режим у локальных токенизаторов
+    // тот же, что у общего, поэтому merge не откажет)
+    for (const auto& local : local_tokenizers) {
+        tokenizer.merge(local);
+    }
+    
+    for (size_t t = 0; t < num_threads; t++) {
+        profile.merge(local_profiles[t]);
+        total_bytes += local_bytes[t];
     }
+    total_tokens = tokenizer.get_token_count();
     
     auto end_total = std::chrono::high_resolution_clock::now();
     double actual_total_time = std::chrono::duration<double>(end_total - start_total).count();
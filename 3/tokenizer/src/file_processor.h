@@ -3,7 +3,7 @@
 
 #include <vector>
 #include <string>
-#include <utility> // для std::pair
+#include "stage_profile.h"
 
 // Предварительное объявление
 class Tokenizer;
@@ -11,18 +11,25 @@ class Tokenizer;
 class FileProcessor {
 private:
     std::vector<std::string> files;
-    std::vector<std::pair<size_t, double>> processing_timings; // размер файла -> время обработки
+    StageProfile profile;  // Задержки этапов по файлам
     
 public:
     void scan_directory(const std::string& path);
+    // num_threads > 1: файлы раздаются потокам динамически (атомарный курсор),
+    // каждый поток токенизирует в свой Tokenizer, в конце результаты сливаются
+    // в tokenizer. С однопоточным запуском совпадают число токенов, число
+    // уникальных токенов, средняя длина и (в режимах Streaming и KeepTokens)
+    // точный топ-N. Случайная выборка и, в режиме Approximate, оценки
+    // Space-Saving зависят от того, как файлы разошлись по потокам.
     void process_files(Tokenizer& tokenizer, 
                       size_t& total_tokens,
                       double& total_time,
-                      size_t& total_bytes);
+                      size_t& total_bytes,
+                      size_t num_threads = 1);
     
     size_t get_file_count() const { return files.size(); }
     const std::vector<std::string>& get_files() const { return files; }
-    const std::vector<std::pair<size_t, double>>& get_timings() const { return processing_timings; }
+    const StageProfile& get_profile() const { return profile; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a по байтам строки: общий хеш словарей токенизатора и
+// лабораторной 4. Токены короткие, так что простого байтового хеша
+// достаточно. Значения сохраняются в файлах (таблица основ, индекс),
+// поэтому менять функцию нельзя без смены версии этих форматов.
+inline uint32_t fnv1a(std::string_view bytes) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+unsigned highest_bit(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT) {
+    clear();
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t value) {
+    if (value < EXACT_LIMIT) {
+        return static_cast<size_t>(value);
+    }
+    // Старшие SUB_BUCKET_BITS + 1 бит значения: сдвиг задает группу,
+    // остаток (от SUB_BUCKETS до 2 * SUB_BUCKETS - 1) - корзину в группе
+    unsigned shift = highest_bit(value) - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+    return EXACT_LIMIT + (shift - 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < EXACT_LIMIT) {
+        return bucket;
+    }
+    unsigned shift = static_cast<unsigned>((bucket - EXACT_LIMIT) / SUB_BUCKETS) + 1;
+    uint64_t sub = (bucket - EXACT_LIMIT) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucket_of(value)]++;
+    total++;
+    sum += value;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+}
+
+void LatencyHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper(i), max_value);
+        }
+    }
+    return max_value;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Гистограмма задержек в стиле HDR Histogram: значения (наносекунды)
+// до 64 хранятся точно, дальше на каждую степень двойки приходится
+// 32 корзины, т.е. относительная погрешность не больше 1/32 (~3%)
+// во всем диапазоне uint64_t. Запись - O(1) (одна операция clz),
+// память фиксированная (~15 КБ), гистограммы складываются (merge).
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;  // 32
+    static constexpr uint64_t EXACT_LIMIT = SUB_BUCKETS * 2;        // 64
+    static constexpr size_t BUCKET_COUNT = EXACT_LIMIT + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+private:
+    std::vector<uint64_t> counts;  // BUCKET_COUNT корзин
+    uint64_t total;
+    uint64_t min_value;
+    uint64_t max_value;
+    uint64_t sum;
+
+    static size_t bucket_of(uint64_t value);
+    static uint64_t bucket_upper(size_t bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total > 0 ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total > 0 ? static_cast<double>(sum) / total : 0.0; }
+
+    // Значение, не больше которого q-я доля записей (0 < q <= 1);
+    // верхняя граница корзины, но не больше максимума
+    uint64_t percentile(double q) const;
+};
+
+#endif
\ No newline at end of file
@@ -5,8 +5,9 @@
 #include <vector>
 #include <algorithm>
 #include <locale>
-#include <codecvt>
 #include <cwctype>
+#include <thread>
+#include <charconv>
 #include "tokenizer.h"
 #include "file_processor.h"
 
@@ -14,12 +15,6 @@
 #include <windows.h>
 #endif
 
-// Функция для конвертации wstring в UTF-8 string
-std::string wstring_to_utf8(const std::wstring& wstr) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.to_bytes(wstr);
-}
-
 // Функция для вывода топ-N токенов
 void print_top_tokens(const Tokenizer& tokenizer, size_t n) {
     std::cout << "\nТОП-" << n << " самых частых токенов:" << std::endl;
@@ -38,59 +33,13 @@ void print_top_tokens(const Tokenizer& tokenizer, size_t n) {
         double percentage = (static_cast<double>(freq) / total_tokens) * 100.0;
         
         std::cout << std::left << std::setw(5) << i+1
-                  << std::setw(20) << wstring_to_utf8(token).substr(0, 18)
+                  << std::setw(20) << token.substr(0, 18)
                   << std::setw(15) << freq
                   << std::fixed << std::setprecision(4) << percentage << "%" << std::endl;
     }
 }
 
-// Функция для анализа зависимости времени от размера файла
-void analyze_performance(const std::vector<std::pair<size_t, double>>& timings) {
-    if (timings.empty()) return;
-    
-    // Сортируем по размеру файла
-    auto sorted_timings = timings;
-    std::sort(sorted_timings.begin(), sorted_timings.end(),
-              [](const auto& a, const auto& b) { return a.first < b.first; });
-    
-    // Группируем по диапазонам размеров
-    std::vector<std::pair<std::string, double>> size_groups = {
-        {"< 1KB", 0}, {"1-10KB", 0}, {"10-100KB", 0}, {"> 100KB", 0}
-    };
-    std::vector<int> group_counts = {0, 0, 0, 0};
-    
-    for (const auto& [size, time] : sorted_timings) {
-        double size_kb = size / 1024.0;
-        if (size_kb < 1) {
-            size_groups[0].second += time;
-            group_counts[0]++;
-        } else if (size_kb < 10) {
-            size_groups[1].second += time;
-            group_counts[1]++;
-        } else if (size_kb < 100) {
-            size_groups[2].second += time;
-            group_counts[2]++;
-        } else {
-            size_groups[3].second += time;
-            group_counts[3]++;
-        }
-    }
-    
-    std::cout << "\nЗависимость времени обработки от размера файла:" << std::endl;
-    std::cout << std::string(50, '-') << std::endl;
-    for (size_t i = 0; i < size_groups.size(); i++) {
-        if (group_counts[i] > 0) {
-            double avg_time = size_groups[i].second / group_counts[i];
-            std::cout << std::left << std::setw(10) << size_groups[i].first
-                      << ": " << group_counts[i] << " файлов, "
-                      << "среднее время: " << std::fixed << std::setprecision(3) 
-                      << avg_time << " сек" << std::endl;
-        }
-    }
-}
-
 void print_statistics(const Tokenizer& tokenizer, 
-                     const FileProcessor& processor,
                      size_t files_processed,
                      size_t total_bytes,
                      double total_time) {
@@ -109,8 +58,12 @@ void print_statistics(const Tokenizer& tokenizer,
               << " МБ)" << std::endl;
     std::cout << std::left << std::setw(35) << "Всего токенов:" 
               << stats.total_tokens << std::endl;
-    std::cout << std::left << std::setw(35) << "Уникальных токенов:" 
-              << tokenizer.get_token_frequencies().size() << std::endl;
+    std::cout << std::left << std::setw(35) << "Уникальных токенов:";
+    if (tokenizer.get_mode() == Tokenizer::Mode::Approximate) {
+        std::cout << "н/д (словарь не хранится)" << std::endl;
+    } else {
+        std::cout << tokenizer.get_unique_token_count() << std::endl;
+    }
     std::cout << std::left << std::setw(35) << "Средняя длина токена:" 
               << std::fixed << std::setprecision(2) << stats.avg_token_length 
               << " символов" << std::endl;
@@ -130,6 +83,19 @@ void print_statistics(const Tokenizer& tokenizer,
               << " токенов/сек" << std::endl;
 }
 
+// Неотрицательное целое из аргумента командной строки целиком;
+// false, если это не число или оно не помещается в size_t
+static bool parse_count(const std::string& text, size_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+static void print_usage(const char* program) {
+    std::cerr << "Использование: " << program << " [путь_к_корпусу] [потоков] [--threads=N] [--approximate] [--latency-json=<файл>]" << std::endl;
+    std::cerr << "Пример: " << program << " corpus_clean --threads=4" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     // Установка кодировки UTF-8 для Windows
 #ifdef _WIN32
@@ -143,16 +109,64 @@ int main(int argc, char* argv[]) {
     std::cout << "Лабораторная работа №3: Токенизация" << std::endl;
     std::cout << "====================================" << std::endl;
     
-    // Путь к данным
+    // [путь_к_корпусу]: по умолчанию corpus_clean
+    // [потоков] или --threads=N: потоков обработки (0 или без параметра -
+    // по числу ядер)
+    // --approximate: частые токены оцениваются в фиксированной памяти,
+    // словарь не хранится (для потоков, не помещающихся в память)
+    // --latency-json=<файл>: сохранить задержки этапов в JSON
     std::string data_path = "corpus_clean";
-    if (argc > 1) {
-        data_path = argv[1];
+    size_t num_threads = 0;
+    bool approximate = false;
+    std::string latency_json;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--approximate") {
+            approximate = true;
+        } else if (arg.rfind("--latency-json=", 0) == 0) {
+            latency_json = arg.substr(std::string("--latency-json=").size());
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            std::string value = arg.substr(std::string("--threads=").size());
+            if (!parse_count(value, num_threads)) {
+                std::cerr << "Неверное число потоков: '" << value << "'" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Неизвестный параметр: '" << arg << "'" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        } else if (positional == 0) {
+            data_path = arg;
+            positional++;
+        } else if (positional == 1) {
+            if (!parse_count(arg, num_threads)) {
+                std::cerr << "Неверное число потоков: '" << arg << "'" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+            positional++;
+        } else {
+            std::cerr << "Лишний аргумент: '" << arg << "'" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
     }
     
     std::cout << "Директория с данными: " << data_path << std::endl;
+    std::cout << "Потоков: " << num_threads << std::endl;
+    if (approximate) {
+        std::cout << "Режим: приближенный топ токенов (Space-Saving)" << std::endl;
+    }
     
-    // Инициализация
-    Tokenizer tokenizer;
+    // Инициализация: храним только счетчики, частоты и выборку токенов,
+    // поэтому память зависит от размера словаря, а не корпуса
+    Tokenizer tokenizer(approximate ? Tokenizer::Mode::Approximate
+                                    : Tokenizer::Mode::Streaming);
     FileProcessor processor;
     
     // Сканирование директории
@@ -174,40 +188,48 @@ int main(int argc, char* argv[]) {
     size_t total_bytes = 0;
     double total_time = 0.0;
     
-    processor.process_files(tokenizer, total_tokens, total_time, total_bytes);
+    processor.process_files(tokenizer, total_tokens, total_time, total_bytes, num_threads);
     
     // Вывод статистики
-    print_statistics(tokenizer, processor, processor.get_file_count(), 
+    print_statistics(tokenizer, processor.get_file_count(), 
                      total_bytes, total_time);
     
     // Вывод топ-20 токенов
     print_top_tokens(tokenizer, 20);
     
-    // Анализ производительности ← ТОЛЬКО ОДИН РАЗ!
-    analyze_performance(processor.get_timings());
+    // Задержки по этапам и размерам файлов (p50/p90/p99/max)
+    processor.get_profile().print(std::cout);
+    if (!latency_json.empty()) {
+        std::ofstream json(latency_json);
+        if (json) {
+            processor.get_profile().write_json(json);
+            std::cout << "Задержки сохранены в " << latency_json << std::endl;
+        } else {
+            std::cerr << "Не удалось записать " << latency_json << std::endl;
+        }
+    }
     
     // Примеры токенов
-    std::cout << "\nПримеры токенов (первые 10):" << std::endl;
-    auto tokens = tokenizer.get_tokens();
+    std::cout << "\nПримеры токенов (случайная выборка):" << std::endl;
+    auto tokens = tokenizer.get_sample_tokens();
     for (size_t i = 0; i < std::min((size_t)10, tokens.size()); i++) {
-        std::cout << i+1 << ". '" << wstring_to_utf8(tokens[i]) << "'" << std::endl;
+        std::cout << i+1 << ". '" << tokens[i] << "'" << std::endl;
     }
     
     // Примеры сложных токенов
     std::cout << "\nПримеры сложных токенов:" << std::endl;
-    std::vector<std::wstring> examples = {
-        L"ко-ко", L"c++", L"3.14", L"о'коннор", L"at&t"
+    std::vector<std::string> examples = {
+        "ко-ко", "c++", "3.14", "о'коннор", "at&t"
     };
     
     for (const auto& example : examples) {
-        std::cout << "  " << wstring_to_utf8(example) << " -> ";
+        std::cout << "  " << example << " -> ";
         // Создаем временный токенайзер для примера
         Tokenizer temp_tokenizer;
-        std::string example_str = wstring_to_utf8(example);
-        temp_tokenizer.process_text(example_str);
+        temp_tokenizer.process_text(example);
         auto temp_tokens = temp_tokenizer.get_tokens();
         if (!temp_tokens.empty()) {
-            std::cout << "'" << wstring_to_utf8(temp_tokens[0]) << "'";
+            std::cout << "'" << temp_tokens[0] << "'";
         }
         std::cout << std::endl;
     }
@@ -0,0 +1,127 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data(nullptr), size(0), mapping_handle(nullptr) {}
+
+bool MappedFile::open(const std::string& filename, Access access) {
+    unmap();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING,
+                              access == Access::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // Пустой файл отобразить нельзя, но это и не ошибка
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(file_size.QuadPart);
+    mapping_handle = mapping;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        CloseHandle(static_cast<HANDLE>(mapping_handle));
+    }
+    data = nullptr;
+    size = 0;
+    mapping_handle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+
+bool MappedFile::open(const std::string& filename, Access access) {
+    unmap();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Пустой файл отобразить нельзя, но это и не ошибка
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение остается действительным и после закрытия дескриптора
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    madvise(addr, static_cast<size_t>(st.st_size),
+            access == Access::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+    data = static_cast<const char*>(addr);
+    size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+void MappedFile::swap(MappedFile& other) {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+#ifdef _WIN32
+    std::swap(mapping_handle, other.mapping_handle);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Файл, отображенный в память только для чтения. Файл открывается один раз,
+// размер берется из отображения, данные читаются без копирования в std::string.
+// Ядру подсказывается порядок чтения: последовательный (по умолчанию,
+// MADV_SEQUENTIAL) или произвольный (MADV_RANDOM - для таблиц поиска).
+class MappedFile {
+public:
+    enum class Access {
+        Sequential,
+        Random
+    };
+
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    void* mapping_handle;
+#endif
+
+    void unmap();
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false, если файл не удалось открыть или отобразить
+    bool open(const std::string& filename, Access access = Access::Sequential);
+    // Обмен отображениями: файл можно открыть и проверить отдельно,
+    // а потом подставить на место текущего
+    void swap(MappedFile& other);
+
+    std::string_view view() const { return std::string_view(data, size); }
+    size_t get_size() const { return size; }
+};
+
+#endif
\ No newline at end of file
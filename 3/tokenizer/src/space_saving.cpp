@@ -0,0 +1,203 @@
+#include "space_saving.h"
+#include "fnv1a.h"
+#include <algorithm>
+
+namespace {
+
+size_t table_size_for(size_t capacity) {
+    // Заполненность хеш-таблицы не более 1/2
+    size_t size = 16;
+    while (size < capacity * 2) {
+        size *= 2;
+    }
+    return size;
+}
+
+} // namespace
+
+SpaceSaving::SpaceSaving(size_t capacity) : capacity(capacity) {
+    clear();
+}
+
+size_t SpaceSaving::find_slot(std::string_view term) const {
+    size_t i = fnv1a(term) & mask;
+    while (slots[i] != 0 && items[slots[i] - 1].term != term) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void SpaceSaving::insert_slot(uint32_t index) {
+    size_t i = find_slot(items[index].term);
+    slots[i] = index + 1;
+}
+
+void SpaceSaving::remove_slot(size_t slot) {
+    // Удаление с обратным сдвигом: цепочки линейного пробирования
+    // остаются непрерывными без "надгробий"
+    size_t i = slot;
+    size_t j = slot;
+    for (;;) {
+        slots[i] = 0;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (slots[j] == 0) {
+                return;
+            }
+            size_t k = fnv1a(items[slots[j] - 1].term) & mask;
+            bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+            if (!stays) {
+                break;
+            }
+        }
+        slots[i] = slots[j];
+        i = j;
+    }
+}
+
+void SpaceSaving::sift_up(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (items[heap[parent]].count <= items[heap[pos]].count) {
+            break;
+        }
+        std::swap(heap[parent], heap[pos]);
+        heap_pos[heap[parent]] = static_cast<uint32_t>(parent);
+        heap_pos[heap[pos]] = static_cast<uint32_t>(pos);
+        pos = parent;
+    }
+}
+
+void SpaceSaving::sift_down(size_t pos) {
+    size_t n = heap.size();
+    for (;;) {
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < n && items[heap[left]].count < items[heap[smallest]].count) {
+            smallest = left;
+        }
+        if (right < n && items[heap[right]].count < items[heap[smallest]].count) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        std::swap(heap[smallest], heap[pos]);
+        heap_pos[heap[smallest]] = static_cast<uint32_t>(smallest);
+        heap_pos[heap[pos]] = static_cast<uint32_t>(pos);
+        pos = smallest;
+    }
+}
+
+void SpaceSaving::add(std::string_view term, size_t count) {
+    if (capacity == 0) {
+        return;
+    }
+
+    size_t slot = find_slot(term);
+    if (slots[slot] != 0) {
+        uint32_t index = slots[slot] - 1;
+        items[index].count += count;
+        sift_down(heap_pos[index]);
+        return;
+    }
+
+    if (items.size() < capacity) {
+        uint32_t index = static_cast<uint32_t>(items.size());
+        items.push_back({std::string(term), count, 0});
+        heap.push_back(index);
+        heap_pos.push_back(static_cast<uint32_t>(heap.size() - 1));
+        slots[slot] = index + 1;
+        sift_up(heap.size() - 1);
+        return;
+    }
+
+    // Вытесняем терм с минимальным счетчиком: новый наследует его счетчик
+    uint32_t victim = heap[0];
+    remove_slot(find_slot(items[victim].term));
+
+    Item& item = items[victim];
+    size_t min = item.count;
+    item.term.assign(term.data(), term.size());
+    item.count = min + count;
+    item.error = min;
+
+    insert_slot(victim);
+    sift_down(0);
+}
+
+size_t SpaceSaving::min_count() const {
+    return heap.empty() ? 0 : items[heap[0]].count;
+}
+
+void SpaceSaving::merge(const SpaceSaving& other) {
+    // Терм, отсутствующий в заполненной сводке, мог встретиться там
+    // не более min_count() раз - добавляем эту величину к оценке и ошибке
+    size_t this_missing = (items.size() == capacity) ? min_count() : 0;
+    size_t other_missing = (other.items.size() == other.capacity) ? other.min_count() : 0;
+
+    std::vector<Item> combined;
+    combined.reserve(items.size() + other.items.size());
+
+    for (const Item& item : items) {
+        size_t slot = other.find_slot(item.term);
+        if (other.slots[slot] != 0) {
+            const Item& match = other.items[other.slots[slot] - 1];
+            combined.push_back({item.term, item.count + match.count, item.error + match.error});
+        } else {
+            combined.push_back({item.term, item.count + other_missing, item.error + other_missing});
+        }
+    }
+    for (const Item& item : other.items) {
+        if (slots[find_slot(item.term)] == 0) {
+            combined.push_back({item.term, item.count + this_missing, item.error + this_missing});
+        }
+    }
+
+    if (combined.size() > capacity) {
+        std::nth_element(combined.begin(), combined.begin() + capacity, combined.end(),
+                         [](const Item& a, const Item& b) { return a.count > b.count; });
+        combined.resize(capacity);
+    }
+    rebuild(std::move(combined));
+}
+
+void SpaceSaving::rebuild(std::vector<Item> new_items) {
+    items = std::move(new_items);
+    slots.assign(table_size_for(capacity), 0);
+    mask = slots.size() - 1;
+
+    heap.resize(items.size());
+    heap_pos.resize(items.size());
+    for (uint32_t i = 0; i < items.size(); i++) {
+        heap[i] = i;
+        heap_pos[i] = i;
+        insert_slot(i);
+    }
+    for (size_t i = heap.size() / 2; i-- > 0;) {
+        sift_down(i);
+    }
+}
+
+std::vector<SpaceSaving::Item> SpaceSaving::top(size_t n) const {
+    std::vector<Item> result = items;
+    n = std::min(n, result.size());
+    std::partial_sort(result.begin(), result.begin() + n, result.end(),
+                      [](const Item& a, const Item& b) {
+                          if (a.count != b.count) {
+                              return a.count > b.count;
+                          }
+                          return a.term < b.term;
+                      });
+    result.resize(n);
+    return result;
+}
+
+void SpaceSaving::clear() {
+    items.clear();
+    heap.clear();
+    heap_pos.clear();
+    slots.assign(table_size_for(capacity), 0);
+    mask = slots.size() - 1;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef SPACE_SAVING_H
+#define SPACE_SAVING_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Приближенный поиск самых частых элементов потока (Space-Saving,
+// Metwally et al., 2005) в фиксированной памяти: отслеживается не более
+// capacity термов. Частота любого терма завышается не больше, чем на
+// минимальный счетчик, поэтому термы с частотой выше N / capacity
+// гарантированно присутствуют в сводке.
+class SpaceSaving {
+public:
+    struct Item {
+        std::string term;
+        size_t count;  // Оценка сверху
+        size_t error;  // Максимальное завышение count
+    };
+
+private:
+    size_t capacity;
+    std::vector<Item> items;
+    std::vector<uint32_t> heap;       // Индексы items, min-куча по count
+    std::vector<uint32_t> heap_pos;   // Позиция каждого элемента в куче
+    std::vector<uint32_t> slots;      // Хеш-таблица: индекс + 1, 0 - пусто
+    size_t mask;
+
+    size_t find_slot(std::string_view term) const;
+    void remove_slot(size_t slot);
+    void insert_slot(uint32_t index);
+    void sift_down(size_t pos);
+    void sift_up(size_t pos);
+    void rebuild(std::vector<Item> new_items);
+
+public:
+    explicit SpaceSaving(size_t capacity = 1024);
+
+    void add(std::string_view term, size_t count = 1);
+
+    // Объединяет сводку другого потока (mergeable summaries, Agarwal et al.)
+    void merge(const SpaceSaving& other);
+
+    // n самых частых по оценке термов, по убыванию count
+    std::vector<Item> top(size_t n) const;
+
+    size_t size() const { return items.size(); }
+    size_t get_capacity() const { return capacity; }
+    size_t min_count() const;
+    void clear();
+};
+
+#endif
\ No newline at end of file
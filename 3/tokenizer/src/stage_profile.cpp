@@ -0,0 +1,128 @@
+#include "stage_profile.h"
+#include <iomanip>
+
+namespace {
+
+const double PERCENTILES[] = {0.5, 0.9, 0.99};
+const char* const PERCENTILE_NAMES[] = {"p50", "p90", "p99"};
+
+double to_microseconds(uint64_t nanoseconds) {
+    return nanoseconds / 1000.0;
+}
+
+void print_row(std::ostream& out, const char* name, const LatencyHistogram& h) {
+    out << std::left << std::setw(12) << name << std::right
+        << std::setw(10) << h.count();
+    for (double q : PERCENTILES) {
+        out << std::setw(12) << to_microseconds(h.percentile(q));
+    }
+    out << std::setw(12) << to_microseconds(h.max()) << std::endl;
+}
+
+void write_histogram(std::ostream& out, const LatencyHistogram& h) {
+    out << "{\"count\": " << h.count()
+        << ", \"mean\": " << h.mean() / 1000.0;
+    for (size_t i = 0; i < 3; i++) {
+        out << ", \"" << PERCENTILE_NAMES[i] << "\": " << to_microseconds(h.percentile(PERCENTILES[i]));
+    }
+    out << ", \"max\": " << to_microseconds(h.max()) << "}";
+}
+
+} // namespace
+
+const char* StageProfile::stage_name(Stage stage) {
+    switch (stage) {
+        case READ: return "read";
+        case TOKENIZE: return "tokenize";
+        case COUNT: return "count";
+        case TOTAL: return "total";
+        default: return "?";
+    }
+}
+
+const char* StageProfile::size_class_name(size_t size_class) {
+    static const char* const names[SIZE_CLASS_COUNT] = {
+        "<1KB", "1-10KB", "10-100KB", "100KB-1MB", ">=1MB"
+    };
+    return size_class < SIZE_CLASS_COUNT ? names[size_class] : "?";
+}
+
+size_t StageProfile::size_class(size_t file_size) {
+    static const size_t limits[SIZE_CLASS_COUNT - 1] = {
+        1024, 10 * 1024, 100 * 1024, 1024 * 1024
+    };
+    size_t cls = 0;
+    while (cls < SIZE_CLASS_COUNT - 1 && file_size >= limits[cls]) {
+        cls++;
+    }
+    return cls;
+}
+
+void StageProfile::record(Stage stage, size_t file_size, uint64_t nanoseconds) {
+    histograms[0][stage].record(nanoseconds);
+    histograms[1 + size_class(file_size)][stage].record(nanoseconds);
+}
+
+void StageProfile::merge(const StageProfile& other) {
+    for (size_t c = 0; c <= SIZE_CLASS_COUNT; c++) {
+        for (size_t s = 0; s < STAGE_COUNT; s++) {
+            histograms[c][s].merge(other.histograms[c][s]);
+        }
+    }
+}
+
+void StageProfile::clear() {
+    for (auto& row : histograms) {
+        for (auto& h : row) {
+            h.clear();
+        }
+    }
+}
+
+void StageProfile::print(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+
+    out << "\nЗадержки по этапам, мкс (все файлы):" << std::endl;
+    out << std::string(70, '-') << std::endl;
+    // std::setw считает байты, поэтому кириллические заголовки выровнены вручную
+    out << "этап        " << "    файлов"
+        << std::setw(12) << "p50" << std::setw(12) << "p90"
+        << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        print_row(out, stage_name(static_cast<Stage>(s)), histograms[0][s]);
+    }
+
+    out << "\nВремя на файл по размеру, мкс:" << std::endl;
+    out << std::string(70, '-') << std::endl;
+    for (size_t c = 0; c < SIZE_CLASS_COUNT; c++) {
+        if (histograms[1 + c][TOTAL].count() > 0) {
+            print_row(out, size_class_name(c), histograms[1 + c][TOTAL]);
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void StageProfile::write_json(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\n  \"unit\": \"us\",\n  \"size_classes\": [\n";
+    for (size_t c = 0; c <= SIZE_CLASS_COUNT; c++) {
+        out << "    {\"name\": \"" << (c == 0 ? "all" : size_class_name(c - 1))
+            << "\", \"stages\": {";
+        for (size_t s = 0; s < STAGE_COUNT; s++) {
+            out << (s > 0 ? "," : "") << "\n      \"" << stage_name(static_cast<Stage>(s)) << "\": ";
+            write_histogram(out, histograms[c][s]);
+        }
+        out << "\n    }}" << (c < SIZE_CLASS_COUNT ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
\ No newline at end of file
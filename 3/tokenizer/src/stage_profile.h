@@ -0,0 +1,48 @@
+#ifndef STAGE_PROFILE_H
+#define STAGE_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include "latency_histogram.h"
+
+// Задержки обработки файлов по этапам и классам размера файла.
+// Для каждого этапа и класса - своя гистограмма (LatencyHistogram),
+// плюс сводная по всем размерам. Профили потоков складываются (merge).
+class StageProfile {
+public:
+    enum Stage {
+        READ,       // Открытие, отображение в память и подкачка страниц
+        TOKENIZE,   // Разбор на токены (декодирование UTF-8 встроено в сканер)
+        COUNT,      // Подсчет: словарь, выборка, частые токены
+        TOTAL,      // Файл целиком
+        STAGE_COUNT
+    };
+
+    // < 1КБ, 1-10КБ, 10-100КБ, 100КБ-1МБ, >= 1МБ
+    static constexpr size_t SIZE_CLASS_COUNT = 5;
+
+private:
+    // [0] - все файлы, [1 + класс] - файлы данного класса размера
+    LatencyHistogram histograms[SIZE_CLASS_COUNT + 1][STAGE_COUNT];
+
+    static size_t size_class(size_t file_size);
+
+public:
+    static const char* stage_name(Stage stage);
+    static const char* size_class_name(size_t size_class);
+
+    // nanoseconds - длительность этапа для файла размером file_size байт
+    void record(Stage stage, size_t file_size, uint64_t nanoseconds);
+    void merge(const StageProfile& other);
+    void clear();
+
+    const LatencyHistogram& get(Stage stage) const { return histograms[0][stage]; }
+
+    // Таблица p50/p90/p99/max по этапам (все файлы) и по классам размера
+    void print(std::ostream& out) const;
+    // То же в JSON (микросекунды)
+    void write_json(std::ostream& out) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "token_scanner.h"
+#include "char_table.h"
+#include "utf8.h"
+#include "word_rules.h"
+
+TokenScanner::TokenScanner() : data(nullptr), len(0), pos(0), prev_c(0), last_length(0) {}
+
+TokenScanner::TokenScanner(std::string_view text) : TokenScanner() {
+    reset(text);
+}
+
+void TokenScanner::reset(std::string_view text) {
+    data = text.data();
+    len = text.length();
+    pos = 0;
+    prev_c = 0;
+    last_length = 0;
+}
+
+bool TokenScanner::next(std::string_view& token) {
+    // UTF-8 декодируется на лету прямо из байтового буфера.
+    // Серии разделителей вне токена и серии букв ASCII/кириллицы
+    // обрабатываются пачками (SIMD), посимвольно с окном
+    // (предыдущий, текущий, следующий) разбираются только остальные символы.
+    const size_t npos = static_cast<size_t>(-1);
+    size_t start = npos;
+    size_t end = len;
+    size_t length = 0;
+    bool needs_fold = false;
+    
+    while (pos < len) {
+        if (start == npos) {
+            // Вне токена ни один ASCII-символ, кроме букв и цифр,
+            // не может начать токен - пропускаем их сразу
+            size_t first = char_table::skip_delimiters(data, pos, len);
+            if (first != pos) {
+                prev_c = static_cast<unsigned char>(data[first - 1]);
+                pos = first;
+                if (pos >= len) {
+                    break;
+                }
+            }
+        }
+        
+        // Быстрый путь: буквы и цифры всегда входят в токен
+        size_t run_end = char_table::scan_run(data, pos, len, length, prev_c, needs_fold);
+        if (run_end != pos) {
+            if (start == npos) {
+                start = pos;
+            }
+            pos = run_end;
+            continue;
+        }
+        
+        // Общий путь: пунктуация, прочие алфавиты, некорректный UTF-8
+        // Решение берется из таблицы правил (word_rules.h); следующий
+        // символ декодируется, только если от него что-то зависит
+        size_t next_pos = pos;
+        char32_t c = utf8::decode(data, len, next_pos);
+        word_rules::CharClass cls = word_rules::class_of(c);
+        word_rules::CharClass prev_cls = word_rules::class_of(prev_c);
+        uint8_t decision = word_rules::tables.decision[cls][prev_cls];
+        bool word = decision == word_rules::WORD;
+        if (decision == word_rules::LOOKAHEAD) {
+            char32_t next_c = 0;
+            if (next_pos < len) {
+                size_t lookahead = next_pos;
+                next_c = utf8::decode(data, len, lookahead);
+            }
+            word = word_rules::tables.word[cls][prev_cls][word_rules::class_of(next_c)];
+        }
+        prev_c = c;
+        
+        if (word) {
+            if (start == npos) {
+                start = pos;
+            }
+            if (char_table::to_lower(c) != c) {
+                needs_fold = true;
+            }
+            length++;
+            pos = next_pos;
+        } else if (start != npos) {
+            // Токен закончился на этом символе
+            end = pos;
+            pos = next_pos;
+            break;
+        } else {
+            pos = next_pos;
+        }
+    }
+    
+    if (start == npos) {
+        return false;
+    }
+    last_length = length;
+    if (needs_fold) {
+        folded.clear();
+        char_table::append_lower(folded, data + start, end - start);
+        token = folded;
+    } else {
+        token = std::string_view(data + start, end - start);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef TOKEN_SCANNER_H
+#define TOKEN_SCANNER_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Потоковый разбор текста UTF-8 на токены без выделения памяти на токен.
+// Токен выдается как std::string_view прямо в исходный буфер; копия
+// в нижнем регистре (во внутренний переиспользуемый буфер) делается,
+// только если регистр действительно меняется.
+//
+// Выданный токен действителен до следующего вызова next()/reset()
+// и пока жив исходный текст.
+class TokenScanner {
+private:
+    const char* data;
+    size_t len;
+    size_t pos;
+    char32_t prev_c;
+    size_t last_length;
+    std::string folded;  // Буфер для токенов, которые пришлось привести к нижнему регистру
+
+public:
+    TokenScanner();
+    explicit TokenScanner(std::string_view text);
+
+    // Начать разбор нового текста (буфер folded переиспользуется)
+    void reset(std::string_view text);
+
+    // Следующий токен; false, когда текст закончился
+    bool next(std::string_view& token);
+
+    // Длина последнего токена в символах
+    size_t token_length() const { return last_length; }
+};
+
+#endif
\ No newline at end of file
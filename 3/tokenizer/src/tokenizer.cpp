@@ -1,173 +1,328 @@
 #include "tokenizer.h"
-#include <fstream>
+#include "mapped_file.h"
+#include "word_rules.h"
 #include <iostream>
 #include <sstream>
 #include <chrono>
 #include <algorithm>
-#include <cwctype>  // Используем этот заголовок для wide char функций
-#include <locale>
-#include <codecvt>
+#include <cmath>
+#include <functional>
 
-Tokenizer::Tokenizer() : total_chars(0) {
-    // Устанавливаем локаль для русских символов
-    try {
-        russian_locale = std::locale("ru_RU.UTF-8");
-    } catch (...) {
-        russian_locale = std::locale();
+namespace {
+
+// Байт, на котором текст можно разрезать без изменения результата:
+// ASCII-символ, который не входит ни в одно контекстное правило
+// (word_rules.h) и потому ведет себя как граница текста
+bool is_cut_byte(unsigned char b) {
+    if (b >= 0x80) {
+        return false;
     }
+    word_rules::CharClass cls = word_rules::class_of(b);
+    return cls == word_rules::OTHER || cls == word_rules::BOUNDARY;
 }
 
-bool Tokenizer::is_digit_or_letter(wchar_t c) const {
-    // Используем функции из cwctype (глобальное пространство имен)
-    return iswalnum(c) || 
-           (c >= L'а' && c <= L'я') || c == L'ё' ||
-           (c >= L'А' && c <= L'Я') || c == L'Ё';
+} // namespace
+
+Tokenizer::Tokenizer(Mode mode, size_t sample_size, size_t top_capacity)
+    : mode(mode), heavy_hitters(mode == Mode::Approximate ? top_capacity : 0),
+      top_capacity(top_capacity), token_count(0), total_chars(0),
+      sample_size(sample_size), sample_weight(0.0), sample_next(0) {
+    clear();
 }
 
-bool Tokenizer::is_word_char(wchar_t c, wchar_t prev_c, wchar_t next_c) const {
-    // Буквы и цифры всегда входят в токены
-    if (is_digit_or_letter(c)) {
-        return true;
+void Tokenizer::add_token(std::string_view token, size_t length) {
+    if (mode == Mode::KeepTokens) {
+        tokens.push_back(vocabulary.add(token));
+    } else {
+        if (mode == Mode::Approximate) {
+            heavy_hitters.add(token);
+        } else {
+            vocabulary.add(token);
+        }
+        add_to_sample(token);
     }
-    
-    // Дефис внутри слова (например, "ко-ко")
-    if (c == L'-' && prev_c != 0 && next_c != 0 && 
-        is_digit_or_letter(prev_c) && is_digit_or_letter(next_c)) {
-        return true;
+    token_count++;
+    total_chars += length;
+}
+
+void Tokenizer::add_to_sample(std::string_view token) {
+    // token_count - порядковый номер текущего токена (с нуля)
+    if (sample_size == 0) {
+        return;
     }
-    
-    // Апостроф внутри слова (например, "o'clock")
-    if (c == L'\'' && prev_c != 0 && next_c != 0 &&
-        is_digit_or_letter(prev_c) && is_digit_or_letter(next_c)) {
-        return true;
+    if (sample.size() < sample_size) {
+        sample.emplace_back(token);
+        if (sample.size() == sample_size) {
+            sample_weight = 1.0;
+            advance_sample();
+        }
+    } else if (token_count == sample_next) {
+        std::uniform_int_distribution<size_t> slot(0, sample_size - 1);
+        sample[slot(sample_rng)].assign(token.data(), token.size());
+        advance_sample();
     }
+}
+
+void Tokenizer::advance_sample() {
+    // Алгоритм L (Li, 1994): сразу вычисляем номер следующего токена,
+    // который попадет в выборку
+    std::uniform_real_distribution<double> uniform(std::nextafter(0.0, 1.0), 1.0);
+    sample_weight *= std::exp(std::log(uniform(sample_rng)) / sample_size);
+    double skip = std::floor(std::log(uniform(sample_rng)) / std::log1p(-sample_weight));
+    sample_next = token_count + 1 + static_cast<size_t>(skip);
+}
+
+void Tokenizer::merge_sample(const Tokenizer& other) {
+    // Выборка из объединенного потока: каждый элемент берется из той
+    // выборки, чья доля еще не выбранных токенов больше (гипергеометрически)
+    std::vector<std::string> a = std::move(sample);
+    std::vector<std::string> b = other.sample;
+    size_t remaining_a = token_count;
+    size_t remaining_b = other.token_count;
     
-    // Амперсанд в названиях (например, "AT&T")
-    if (c == L'&' && prev_c != 0 && next_c != 0 &&
-        is_digit_or_letter(prev_c) && is_digit_or_letter(next_c)) {
-        return true;
+    sample.clear();
+    while (sample.size() < sample_size && (!a.empty() || !b.empty())) {
+        std::uniform_int_distribution<size_t> pick_source(0, remaining_a + remaining_b - 1);
+        bool from_a = !a.empty() && (b.empty() || pick_source(sample_rng) < remaining_a);
+        std::vector<std::string>& source = from_a ? a : b;
+        
+        std::uniform_int_distribution<size_t> pick_item(0, source.size() - 1);
+        size_t k = pick_item(sample_rng);
+        sample.push_back(std::move(source[k]));
+        source[k] = std::move(source.back());
+        source.pop_back();
+        (from_a ? remaining_a : remaining_b)--;
+    }
+}
+
+bool Tokenizer::merge(const Tokenizer& other) {
+    if (other.mode != mode) {
+        return false;
     }
     
-    // Точка в числах (например, "3.14")
-    if (c == L'.' && prev_c != 0 && next_c != 0 &&
-        iswdigit(prev_c) && iswdigit(next_c)) {
-        return true;
+    // Термы другого словаря получают id в нашем словаре
+    const Vocabulary& other_vocabulary = other.vocabulary;
+    std::vector<uint32_t> remap(other_vocabulary.size());
+    for (uint32_t id = 0; id < other_vocabulary.size(); id++) {
+        remap[id] = vocabulary.add(other_vocabulary.term(id), other_vocabulary.count(id));
     }
     
-    // Плюсы в "C++"
-    if (c == L'+' && prev_c != 0 && 
-        (towlower(prev_c) == L'c' || iswdigit(prev_c)) && 
-        next_c == L'+') {
-        return true;
+    if (mode == Mode::KeepTokens) {
+        tokens.reserve(tokens.size() + other.tokens.size());
+        for (uint32_t id : other.tokens) {
+            tokens.push_back(remap[id]);
+        }
+    } else {
+        merge_sample(other);
     }
+    if (mode == Mode::Approximate) {
+        heavy_hitters.merge(other.heavy_hitters);
+    }
+    
+    token_count += other.token_count;
+    total_chars += other.total_chars;
     
-    return false;
+    // Продолжаем алгоритм L с весом, соответствующим объединенному потоку
+    if (mode != Mode::KeepTokens && sample_size > 0 && sample.size() == sample_size) {
+        sample_weight = static_cast<double>(sample_size) / token_count;
+        advance_sample();
+    }
+    return true;
 }
 
-wchar_t Tokenizer::to_lower(wchar_t c) const {
-    // Используем функцию из cwctype (глобальное пространство имен)
-    return towlower(c);
+void Tokenizer::process_text(std::string_view text) {
+    TokenScanner scanner(text);
+    std::string_view token;
+    while (scanner.next(token)) {
+        add_token(token, scanner.token_length());
+    }
 }
 
-void Tokenizer::process_text(const std::string& text) {
-    try {
-        // Конвертируем UTF-8 в wstring
-        std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-        std::wstring wtext = converter.from_bytes(text);
-        
-        std::wstring current_token;
-        bool in_token = false;
-        size_t len = wtext.length();
-        
-        for (size_t i = 0; i < len; i++) {
-            wchar_t c = wtext[i];
-            wchar_t prev_c = (i > 0) ? wtext[i-1] : 0;
-            wchar_t next_c = (i < len-1) ? wtext[i+1] : 0;
-            
-            if (is_word_char(c, prev_c, next_c)) {
-                current_token += to_lower(c);
-                in_token = true;
-            } else if (in_token) {
-                if (!current_token.empty()) {
-                    // Сохраняем токен
-                    tokens.push_back(current_token);
-                    total_chars += current_token.length();
-                    
-                    // Увеличиваем частоту
-                    token_freq[current_token]++;
-                    
-                    current_token.clear();
-                }
-                in_token = false;
+void Tokenizer::process_text(std::string_view text, StageTimes& times) {
+    using clock = std::chrono::steady_clock;
+    const size_t BATCH_SIZE = 256;
+    
+    // Токен пачки: смещение в тексте или, если токен пришлось привести
+    // к нижнему регистру (буфер сканера перезаписывается), в folded
+    struct BatchToken {
+        size_t offset;
+        size_t size;
+        size_t length;
+        bool in_folded;
+    };
+    std::vector<BatchToken> batch;
+    batch.reserve(BATCH_SIZE);
+    std::string folded;
+    
+    TokenScanner scanner(text);
+    std::less<const char*> before;
+    bool done = false;
+    while (!done) {
+        auto start = clock::now();
+        batch.clear();
+        folded.clear();
+        std::string_view token;
+        while (batch.size() < BATCH_SIZE) {
+            if (!scanner.next(token)) {
+                done = true;
+                break;
+            }
+            bool in_text = !before(token.data(), text.data()) &&
+                           before(token.data(), text.data() + text.size());
+            if (in_text) {
+                batch.push_back({static_cast<size_t>(token.data() - text.data()), token.size(),
+                                 scanner.token_length(), false});
+            } else {
+                batch.push_back({folded.size(), token.size(), scanner.token_length(), true});
+                folded.append(token.data(), token.size());
             }
         }
+        auto scanned = clock::now();
         
-        // Последний токен, если есть
-        if (!current_token.empty()) {
-            tokens.push_back(current_token);
-            total_chars += current_token.length();
-            token_freq[current_token]++;
+        for (const BatchToken& t : batch) {
+            const char* base = t.in_folded ? folded.data() : text.data();
+            add_token(std::string_view(base + t.offset, t.size), t.length);
         }
+        auto counted = clock::now();
         
-    } catch (const std::exception& e) {
-        std::cerr << "Ошибка обработки текста: " << e.what() << std::endl;
+        times.tokenize_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(scanned - start).count();
+        times.count_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(counted - scanned).count();
     }
 }
 
-void Tokenizer::process_file(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+size_t Tokenizer::process_file(const std::string& filename) {
+    // Файл отображается в память и токенизируется прямо из отображения
+    MappedFile file;
+    if (!file.open(filename)) {
         std::cerr << "Ошибка открытия файла: " << filename << std::endl;
-        return;
+        return 0;
     }
     
-    // Определяем размер файла
-    file.seekg(0, std::ios::end);
-    size_t file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    // Читаем весь файл
-    std::string text(file_size, '\0');
-    file.read(&text[0], file_size);
-    file.close();
+    process_text(file.view());
+    return file.get_size();
+}
+
+void Tokenizer::feed(std::string_view chunk) {
+    // Первая и последняя точки разреза в порции
+    size_t first = 0;
+    while (first < chunk.size() && !is_cut_byte(static_cast<unsigned char>(chunk[first]))) {
+        first++;
+    }
+    if (first == chunk.size()) {
+        // Разрезать негде (например, очень длинный токен) - копим дальше
+        pending.append(chunk.data(), chunk.size());
+        return;
+    }
+    size_t last = chunk.size() - 1;
+    while (!is_cut_byte(static_cast<unsigned char>(chunk[last]))) {
+        last--;
+    }
     
-    process_text(text);
+    // Хвост прошлой порции дописывается только до первого разреза,
+    // середина порции обрабатывается без копирования
+    pending.append(chunk.data(), first + 1);
+    process_text(pending);
+    if (last > first) {
+        process_text(chunk.substr(first + 1, last - first));
+    }
+    pending.assign(chunk.data() + last + 1, chunk.size() - last - 1);
+}
+
+void Tokenizer::finish() {
+    process_text(pending);
+    pending.clear();
+}
+
+size_t Tokenizer::process_stream(std::istream& in, size_t buffer_size) {
+    std::vector<char> buffer(buffer_size > 0 ? buffer_size : 1);
+    size_t total = 0;
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        size_t n = static_cast<size_t>(in.gcount());
+        if (n == 0) {
+            break;
+        }
+        feed(std::string_view(buffer.data(), n));
+        total += n;
+    }
+    finish();
+    return total;
 }
 
 size_t Tokenizer::get_token_count() const {
-    return tokens.size();
+    return token_count;
 }
 
 double Tokenizer::get_average_length() const {
-    if (tokens.empty()) return 0.0;
-    return static_cast<double>(total_chars) / tokens.size();
+    if (token_count == 0) return 0.0;
+    return static_cast<double>(total_chars) / token_count;
 }
 
-const std::vector<std::wstring>& Tokenizer::get_tokens() const {
-    return tokens;
+std::vector<std::string_view> Tokenizer::get_tokens() const {
+    std::vector<std::string_view> result;
+    result.reserve(tokens.size());
+    for (uint32_t id : tokens) {
+        result.push_back(vocabulary.term(id));
+    }
+    return result;
+}
+
+std::vector<std::string> Tokenizer::get_sample_tokens() const {
+    if (mode == Mode::KeepTokens) {
+        // Все токены и так есть - берем первые
+        size_t n = std::min(sample_size, tokens.size());
+        std::vector<std::string> result;
+        for (size_t i = 0; i < n; i++) {
+            result.emplace_back(vocabulary.term(tokens[i]));
+        }
+        return result;
+    }
+    return sample;
 }
 
-const std::map<std::wstring, size_t>& Tokenizer::get_token_frequencies() const {
-    return token_freq;
+std::vector<std::pair<std::string_view, size_t>> Tokenizer::get_token_frequencies() const {
+    return vocabulary.sorted();
 }
 
-std::vector<std::pair<std::wstring, size_t>> Tokenizer::get_top_tokens(size_t n) const {
-    std::vector<std::pair<std::wstring, size_t>> sorted_tokens;
+std::vector<std::pair<std::string, size_t>> Tokenizer::get_top_tokens(size_t n) const {
+    std::vector<std::pair<std::string, size_t>> sorted_tokens;
     
-    // Копируем токены в вектор для сортировки
-    for (const auto& pair : token_freq) {
-        sorted_tokens.push_back(pair);
+    if (mode == Mode::Approximate) {
+        for (auto& item : heavy_hitters.top(n)) {
+            sorted_tokens.emplace_back(std::move(item.term), item.count);
+        }
+        return sorted_tokens;
     }
     
-    // Сортируем по частоте (по убыванию)
-    std::sort(sorted_tokens.begin(), sorted_tokens.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
+    // "a лучше b": больше частота, при равной - раньше по алфавиту,
+    // чтобы результат не зависел от порядка появления термов
+    // (например, при параллельной обработке)
+    const auto& counts = vocabulary.get_counts();
+    auto better = [&](uint32_t a, uint32_t b) {
+        if (counts[a] != counts[b]) {
+            return counts[a] > counts[b];
+        }
+        return vocabulary.term(a) < vocabulary.term(b);
+    };
+    
+    // Частичный отбор: куча из n лучших, на вершине - худший из них.
+    // O(V log n) времени и O(n) памяти вместо сортировки всего словаря
+    std::vector<uint32_t> heap;
+    heap.reserve(n);
+    for (uint32_t id = 0; id < vocabulary.size() && n > 0; id++) {
+        if (heap.size() < n) {
+            heap.push_back(id);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(id, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = id;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
     
-    // Возвращаем топ-N
-    if (sorted_tokens.size() > n) {
-        sorted_tokens.resize(n);
+    for (uint32_t id : heap) {
+        sorted_tokens.emplace_back(std::string(vocabulary.term(id)), counts[id]);
     }
     
     return sorted_tokens;
@@ -175,13 +330,21 @@ std::vector<std::pair<std::wstring, size_t>> Tokenizer::get_top_tokens(size_t n)
 
 void Tokenizer::clear() {
     tokens.clear();
-    token_freq.clear();
+    vocabulary.clear();
+    heavy_hitters.clear();
+    pending.clear();
+    token_count = 0;
     total_chars = 0;
+    
+    sample.clear();
+    sample_rng.seed(20240901);  // Фиксированное зерно - воспроизводимая выборка
+    sample_weight = 0.0;
+    sample_next = 0;
 }
 
 Tokenizer::Statistics Tokenizer::get_statistics() const {
     Statistics stats;
-    stats.total_tokens = tokens.size();
+    stats.total_tokens = token_count;
     stats.total_chars = total_chars;
     stats.avg_token_length = get_average_length();
     return stats;
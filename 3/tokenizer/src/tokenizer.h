@@ -3,37 +3,124 @@
 
 #include <vector>
 #include <string>
-#include <map>
-#include <locale>
-#include <codecvt>
+#include <string_view>
+#include <istream>
 #include <cstddef>
+#include <random>
+#include <cstdint>
+#include "token_scanner.h"
+#include "vocabulary.h"
+#include "space_saving.h"
 
 class Tokenizer {
+public:
+    enum class Mode {
+        KeepTokens,  // Хранить все токены (get_tokens)
+        Streaming,   // Только счетчики, частоты и случайная выборка токенов
+        Approximate  // Как Streaming, но без словаря: частые токены
+                     // оцениваются в фиксированной памяти (Space-Saving)
+    };
+    
 private:
-    std::vector<std::wstring> tokens;
-    std::map<std::wstring, size_t> token_freq;
+    Mode mode;
+    
+    // Словарь с частотами; токены хранятся как id термов словаря
+    Vocabulary vocabulary;
+    std::vector<uint32_t> tokens;
+    SpaceSaving heavy_hitters;  // Только в режиме Approximate
+    size_t top_capacity;
+    size_t token_count;
     size_t total_chars;
-    std::locale russian_locale;
     
-    bool is_word_char(wchar_t c, wchar_t prev_c = 0, wchar_t next_c = 0) const;
-    wchar_t to_lower(wchar_t c) const;
-    bool is_digit_or_letter(wchar_t c) const;
+    // Выборка токенов фиксированного размера (резервуар, алгоритм L):
+    // случайные числа нужны только при замене элемента, а не на каждый токен
+    size_t sample_size;
+    std::vector<std::string> sample;
+    std::mt19937_64 sample_rng;
+    double sample_weight;
+    size_t sample_next;
+    
+    // Хвост предыдущей порции feed(), который еще может продолжиться
+    // в следующей: незаконченный токен, символ UTF-8 или контекст
+    // вроде "c+" или "3."
+    std::string pending;
+    
+    void add_token(std::string_view token, size_t length);
+    void add_to_sample(std::string_view token);
+    void advance_sample();
+    void merge_sample(const Tokenizer& other);
     
 public:
-    Tokenizer();
+    explicit Tokenizer(Mode mode = Mode::KeepTokens, size_t sample_size = 10,
+                       size_t top_capacity = 4096);
     
-    void process_text(const std::string& text);
-    void process_file(const std::string& filename);
+    void process_text(std::string_view text);
+    
+    // Длительности этапов обработки текста, наносекунды
+    struct StageTimes {
+        uint64_t tokenize_ns = 0;
+        uint64_t count_ns = 0;
+    };
+    // То же, что process_text, но токены разбираются и учитываются
+    // пачками, и время разбора и подсчета замеряется отдельно
+    // (два вызова часов на пачку, а не на токен)
+    void process_text(std::string_view text, StageTimes& times);
+    // Возвращает размер файла в байтах (0, если файл не открылся)
+    size_t process_file(const std::string& filename);
+    
+    // Потоковая обработка порциями произвольного размера: результат тот же,
+    // что у process_text для склеенного текста. Порция делится по последнему
+    // ASCII-разделителю, который не может войти в токен; остаток копируется
+    // и обрабатывается вместе со следующей порцией. finish() завершает поток.
+    void feed(std::string_view chunk);
+    void finish();
+    // Читает поток (файл, канал, stdin) буфером фиксированного размера,
+    // возвращает число прочитанных байт
+    size_t process_stream(std::istream& in, size_t buffer_size = 1 << 16);
     
     size_t get_token_count() const;
     double get_average_length() const;
-    const std::vector<std::wstring>& get_tokens() const;
-    const std::map<std::wstring, size_t>& get_token_frequencies() const;
+    // Токены (UTF-8, нижний регистр); пусто в режиме Streaming.
+    // Строки ссылаются на словарь и действительны до следующей обработки
+    std::vector<std::string_view> get_tokens() const;
+    const std::vector<uint32_t>& get_token_ids() const { return tokens; }
+    std::vector<std::string> get_sample_tokens() const;
+    Mode get_mode() const { return mode; }
+    // Параметры конструктора: по ним строятся токенизаторы потоков
+    size_t get_sample_size() const { return sample_size; }
+    size_t get_top_capacity() const { return top_capacity; }
     
-    std::vector<std::pair<std::wstring, size_t>> get_top_tokens(size_t n) const;
+    const Vocabulary& get_vocabulary() const { return vocabulary; }
+    size_t get_unique_token_count() const { return vocabulary.size(); }  // 0 в режиме Approximate
+    // Частоты, отсортированные по токену (строятся по запросу)
+    std::vector<std::pair<std::string_view, size_t>> get_token_frequencies() const;
+    
+    // Топ-N по частоте: точный (частичный отбор по словарю) или,
+    // в режиме Approximate, оценка Space-Saving
+    std::vector<std::pair<std::string, size_t>> get_top_tokens(size_t n) const;
     
     void clear();
     
+    // Добавляет результаты другого токенизатора (например, из другого потока):
+    // частоты и счетчики суммируются, выборки объединяются пропорционально
+    // числу токенов. Порядок токенов между токенизаторами не сохраняется.
+    // Режимы должны совпадать: иначе часть данных (токены или оценки
+    // Space-Saving) не перенести, и счетчики разошлись бы с содержимым -
+    // тогда false и токенизатор не меняется
+    bool merge(const Tokenizer& other);
+    
+    // Обход токенов текста без их сохранения и без выделения памяти
+    // на токен: callback получает std::string_view, действительный
+    // только на время вызова
+    template <typename Callback>
+    static void for_each_token(std::string_view text, Callback&& callback) {
+        TokenScanner scanner(text);
+        std::string_view token;
+        while (scanner.next(token)) {
+            callback(token);
+        }
+    }
+    
     struct Statistics {
         size_t files_processed;
         size_t total_tokens;
@@ -0,0 +1,87 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Минимальные функции для работы с UTF-8 без промежуточных wide-строк
+namespace utf8 {
+
+// Декодирует один символ UTF-8, начиная с data[pos], и сдвигает pos за него.
+// Некорректные и обрезанные последовательности заменяются на U+FFFD,
+// который не является символом слова и просто разделяет токены.
+inline char32_t decode(const char* data, size_t len, size_t& pos) {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+    unsigned char b0 = s[pos];
+    
+    if (b0 < 0x80) {
+        pos += 1;
+        return b0;
+    }
+    
+    size_t extra;
+    char32_t cp;
+    if ((b0 & 0xE0) == 0xC0) {
+        extra = 1;
+        cp = b0 & 0x1F;
+    } else if ((b0 & 0xF0) == 0xE0) {
+        extra = 2;
+        cp = b0 & 0x0F;
+    } else if ((b0 & 0xF8) == 0xF0) {
+        extra = 3;
+        cp = b0 & 0x07;
+    } else {
+        pos += 1;
+        return 0xFFFD;
+    }
+    
+    if (pos + extra >= len) {
+        pos += 1;
+        return 0xFFFD;
+    }
+    
+    for (size_t k = 1; k <= extra; k++) {
+        unsigned char b = s[pos + k];
+        if ((b & 0xC0) != 0x80) {
+            pos += 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    
+    pos += extra + 1;
+    return cp;
+}
+
+// Число символов в строке UTF-8: байты продолжения (10xxxxxx) не считаются
+inline size_t length(std::string_view s) {
+    size_t count = 0;
+    for (char c : s) {
+        count += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+// Дописывает символ в строку в кодировке UTF-8
+inline void append(std::string& out, char32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace utf8
+
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "vocabulary.h"
+#include "fnv1a.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 1024;  // Степень двойки
+
+} // namespace
+
+Vocabulary::Vocabulary() {
+    clear();
+}
+
+uint32_t Vocabulary::add(std::string_view term, size_t count) {
+    uint32_t h = fnv1a(term);
+    size_t i = h & mask;
+
+    while (slots[i] != 0) {
+        uint32_t id = slots[i] - 1;
+        const Entry& e = entries[id];
+        if (e.hash == h && e.length == term.size() &&
+            std::memcmp(arena.data() + e.offset, term.data(), term.size()) == 0) {
+            counts[id] += count;
+            return id;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Новый терм
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    entries.push_back({static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(term.size()), h});
+    arena.append(term.data(), term.size());
+    counts.push_back(count);
+    slots[i] = id + 1;
+
+    // Заполненность не более 1/2
+    if (entries.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+uint32_t Vocabulary::find(std::string_view term) const {
+    uint32_t h = fnv1a(term);
+    size_t i = h & mask;
+
+    while (slots[i] != 0) {
+        uint32_t id = slots[i] - 1;
+        const Entry& e = entries[id];
+        if (e.hash == h && e.length == term.size() &&
+            std::memcmp(arena.data() + e.offset, term.data(), term.size()) == 0) {
+            return id;
+        }
+        i = (i + 1) & mask;
+    }
+    return NOT_FOUND;
+}
+
+void Vocabulary::grow() {
+    std::vector<uint32_t> new_slots(slots.size() * 2, 0);
+    size_t new_mask = new_slots.size() - 1;
+
+    // Хеши сохранены, поэтому перестройка не трогает байты термов
+    for (uint32_t id = 0; id < entries.size(); id++) {
+        size_t i = entries[id].hash & new_mask;
+        while (new_slots[i] != 0) {
+            i = (i + 1) & new_mask;
+        }
+        new_slots[i] = id + 1;
+    }
+
+    slots.swap(new_slots);
+    mask = new_mask;
+}
+
+std::vector<std::pair<std::string_view, size_t>> Vocabulary::sorted() const {
+    std::vector<std::pair<std::string_view, size_t>> result;
+    result.reserve(entries.size());
+    for (uint32_t id = 0; id < entries.size(); id++) {
+        result.emplace_back(term(id), counts[id]);
+    }
+    // Побайтовое сравнение UTF-8 совпадает с порядком кодовых точек
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t Vocabulary::memory_usage() const {
+    return arena.capacity() +
+           entries.capacity() * sizeof(Entry) +
+           counts.capacity() * sizeof(size_t) +
+           slots.capacity() * sizeof(uint32_t);
+}
+
+void Vocabulary::clear() {
+    arena.clear();
+    entries.clear();
+    counts.clear();
+    slots.assign(INITIAL_SLOTS, 0);
+    mask = INITIAL_SLOTS - 1;
+}
\ No newline at end of file
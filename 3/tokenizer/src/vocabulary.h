@@ -0,0 +1,55 @@
+#ifndef VOCABULARY_H
+#define VOCABULARY_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Словарь термов с интернированием: каждому уникальному токену
+// присваивается плотный идентификатор 0, 1, 2, ... в порядке появления.
+// Байты термов (UTF-8) лежат подряд в одном буфере, поиск - открытая
+// адресация с линейным пробированием. Сортировка - только по запросу.
+class Vocabulary {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+private:
+    struct Entry {
+        uint32_t offset;  // Смещение терма в arena
+        uint32_t length;  // Длина терма в байтах
+        uint32_t hash;
+    };
+
+    std::string arena;
+    std::vector<Entry> entries;
+    std::vector<size_t> counts;
+    std::vector<uint32_t> slots;  // id + 1, 0 - пустая ячейка
+    size_t mask;
+
+    void grow();
+
+public:
+    Vocabulary();
+
+    // Возвращает id терма, добавляя его при необходимости, и увеличивает частоту
+    uint32_t add(std::string_view term, size_t count = 1);
+    uint32_t find(std::string_view term) const;
+
+    size_t size() const { return entries.size(); }
+    std::string_view term(uint32_t id) const {
+        return std::string_view(arena.data() + entries[id].offset, entries[id].length);
+    }
+    size_t count(uint32_t id) const { return counts[id]; }
+    const std::vector<size_t>& get_counts() const { return counts; }
+
+    // Пары (терм, частота), отсортированные по терму
+    std::vector<std::pair<std::string_view, size_t>> sorted() const;
+
+    size_t memory_usage() const;
+    void clear();
+};
+
+#endif
\ No newline at end of file
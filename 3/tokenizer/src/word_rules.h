@@ -0,0 +1,145 @@
+#ifndef WORD_RULES_H
+#define WORD_RULES_H
+
+#include <cstdint>
+#include "char_table.h"
+
+// Правила границ токенов в одном месте: входит ли символ в токен,
+// в зависимости от классов предыдущего и следующего символов.
+// Правила записаны декларативно (RULES), таблицы переходов по ним
+// строятся при компиляции и проверяются static_assert.
+namespace word_rules {
+
+enum CharClass : uint8_t {
+    BOUNDARY,    // Символа нет (начало или конец текста)
+    LETTER,      // Буква или цифра, кроме перечисленных ниже
+    LETTER_C,    // 'c' / 'C' - может стоять перед "++"
+    DIGIT,       // Цифра ASCII
+    HYPHEN,
+    APOSTROPHE,
+    AMPERSAND,
+    DOT,
+    PLUS,
+    OTHER,       // Прочие символы - всегда разделители
+    CLASS_COUNT
+};
+
+constexpr uint16_t bit(CharClass c) {
+    return static_cast<uint16_t>(1u << c);
+}
+
+constexpr uint16_t ANY = (1u << CLASS_COUNT) - 1;
+constexpr uint16_t ALNUM = bit(LETTER) | bit(LETTER_C) | bit(DIGIT);
+
+// Символ класса cls входит в токен, если предыдущий символ принадлежит
+// одному из классов prev, а следующий - одному из классов next
+struct Rule {
+    CharClass cls;
+    uint16_t prev;
+    uint16_t next;
+};
+
+constexpr Rule RULES[] = {
+    {LETTER,     ANY, ANY},                                // Буквы и цифры - всегда
+    {LETTER_C,   ANY, ANY},
+    {DIGIT,      ANY, ANY},
+    {HYPHEN,     ALNUM, ALNUM},                            // "ко-ко"
+    {APOSTROPHE, ALNUM, ALNUM},                            // "o'clock"
+    {AMPERSAND,  ALNUM, ALNUM},                            // "AT&T"
+    {DOT,        bit(DIGIT), bit(DIGIT)},                  // "3.14"
+    {PLUS,       bit(LETTER_C) | bit(DIGIT), bit(PLUS)},   // "C++"
+};
+
+// Решение по текущему и предыдущему символам; следующий символ
+// нужно декодировать только для LOOKAHEAD
+enum Decision : uint8_t {
+    BREAK,
+    WORD,
+    LOOKAHEAD
+};
+
+struct Tables {
+    uint8_t ascii_class[0x80];
+    bool word[CLASS_COUNT][CLASS_COUNT][CLASS_COUNT];  // [cls][prev][next]
+    uint8_t decision[CLASS_COUNT][CLASS_COUNT];        // [cls][prev]
+};
+
+constexpr Tables build_tables() {
+    Tables t{};
+
+    for (int c = 1; c < 0x80; c++) {
+        t.ascii_class[c] = OTHER;
+    }
+    t.ascii_class[0] = BOUNDARY;
+    for (int c = 'a'; c <= 'z'; c++) {
+        t.ascii_class[c] = LETTER;
+        t.ascii_class[c - 'a' + 'A'] = LETTER;
+    }
+    t.ascii_class['c'] = LETTER_C;
+    t.ascii_class['C'] = LETTER_C;
+    for (int c = '0'; c <= '9'; c++) {
+        t.ascii_class[c] = DIGIT;
+    }
+    t.ascii_class['-'] = HYPHEN;
+    t.ascii_class['\''] = APOSTROPHE;
+    t.ascii_class['&'] = AMPERSAND;
+    t.ascii_class['.'] = DOT;
+    t.ascii_class['+'] = PLUS;
+
+    for (const Rule& rule : RULES) {
+        for (int prev = 0; prev < CLASS_COUNT; prev++) {
+            for (int next = 0; next < CLASS_COUNT; next++) {
+                if ((rule.prev >> prev & 1) && (rule.next >> next & 1)) {
+                    t.word[rule.cls][prev][next] = true;
+                }
+            }
+        }
+    }
+
+    for (int cls = 0; cls < CLASS_COUNT; cls++) {
+        for (int prev = 0; prev < CLASS_COUNT; prev++) {
+            int words = 0;
+            for (int next = 0; next < CLASS_COUNT; next++) {
+                words += t.word[cls][prev][next];
+            }
+            t.decision[cls][prev] = words == 0 ? BREAK : words == CLASS_COUNT ? WORD : LOOKAHEAD;
+        }
+    }
+    return t;
+}
+
+inline constexpr Tables tables = build_tables();
+
+static_assert(tables.decision[LETTER][BOUNDARY] == WORD, "буквы входят в токен всегда");
+static_assert(tables.decision[DIGIT][OTHER] == WORD, "цифры входят в токен всегда");
+static_assert(tables.decision[OTHER][LETTER] == BREAK, "прочие символы - разделители");
+static_assert(tables.decision[BOUNDARY][LETTER] == BREAK, "конец текста не входит в токен");
+static_assert(tables.word[HYPHEN][LETTER][LETTER_C], "дефис внутри слова");
+static_assert(!tables.word[HYPHEN][LETTER][BOUNDARY], "дефис в конце текста");
+static_assert(!tables.word[HYPHEN][HYPHEN][LETTER], "двойной дефис");
+static_assert(tables.word[APOSTROPHE][LETTER][LETTER], "апостроф внутри слова");
+static_assert(tables.word[AMPERSAND][LETTER][LETTER], "амперсанд внутри слова");
+static_assert(tables.word[DOT][DIGIT][DIGIT], "точка в числе");
+static_assert(!tables.word[DOT][LETTER][DIGIT], "точка после буквы - конец предложения");
+static_assert(tables.word[PLUS][LETTER_C][PLUS], "первый плюс в \"c++\"");
+static_assert(tables.word[PLUS][DIGIT][PLUS], "плюс после цифры перед плюсом");
+static_assert(!tables.word[PLUS][PLUS][OTHER], "второй плюс в \"c++\" токен не продолжает");
+static_assert(!tables.word[PLUS][LETTER][PLUS], "\"a++\" - не токен с плюсами");
+static_assert(tables.decision[PLUS][LETTER] == BREAK, "после обычной буквы плюс - разделитель");
+
+// Класс символа; 0 (нет символа) - BOUNDARY, как и в правилах
+inline CharClass class_of(char32_t c) {
+    if (c < 0x80) {
+        return static_cast<CharClass>(tables.ascii_class[c]);
+    }
+    // Вне ASCII нет ни 'c', ни цифр ASCII, ни пунктуации из правил
+    return char_table::is_letter_or_digit(c) ? LETTER : OTHER;
+}
+
+inline bool is_word_char(char32_t c, char32_t prev_c, char32_t next_c) {
+    return tables.word[class_of(c)][class_of(prev_c)][class_of(next_c)];
+}
+
+} // namespace word_rules
+
+#endif
\ No newline at end of file
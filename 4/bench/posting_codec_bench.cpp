@@ -0,0 +1,213 @@
+// Бенчмарк сжатия постингов: размер кода и скорость распаковки против
+// чтения тех же чисел несжатыми из памяти.
+//
+// Запуск: posting_codec_bench [фильтр] [--quick]
+//   фильтр  - выполнять только тесты, в названии которых есть эта подстрока
+//   --quick - короткие замеры на меньших массивах (менее точные)
+//
+// Числа - разности возрастающих последовательностей, как в индексе:
+// id документов частого и редкого терма и позиции в документе. Массив
+// больше кэша процессора, распаковка идет блоками по
+// PositionalIndex::BLOCK_SIZE в небольшой буфер (как у курсора индекса)
+// с префиксными суммами. Строка "несжатые" - сумма того же числа
+// значений из массива uint32_t: ее скорость ограничена пропускной
+// способностью памяти. Распаковка быстрее нее - сжатие окупается.
+// Каждый замер сверяет сумму распакованных значений с исходной.
+
+#include "posting_codec.h"
+#include "positional_index.h"
+#include "utf8.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+
+// Не дает компилятору выбросить результаты замеряемого кода
+volatile uint64_t sink = 0;
+
+double min_time_sec = 0.5;
+std::string filter;
+
+const size_t BLOCK = PositionalIndex::BLOCK_SIZE;
+
+// Лучшее время одного вызова: прогревочный вызов, затем повторы,
+// пока суммарное время не превысит min_time_sec (не меньше трех повторов)
+template <typename Function>
+double measure(Function&& function) {
+    function();
+    double best = 1e100;
+    double total = 0.0;
+    size_t runs = 0;
+    while (total < min_time_sec || runs < 3) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        best = std::min(best, elapsed);
+        total += elapsed;
+        runs++;
+    }
+    return best;
+}
+
+bool selected(const std::string& name) {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+// Дополняет строку пробелами до width символов (std::setw считает байты)
+std::string pad(const std::string& text, size_t width, bool left_align) {
+    size_t chars = utf8::length(text);
+    std::string padding(chars < width ? width - chars : 0, ' ');
+    return left_align ? text + padding : padding + text;
+}
+
+std::string format(double value, int precision) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+void print_header() {
+    std::cout << pad("Тест", 40, true) << pad("мс/итер", 10, false) << pad("млн чисел/с", 14, false)
+              << pad("ГБ/с", 8, false) << pad("бит/число", 12, false) << std::endl;
+    std::cout << std::string(84, '-') << std::endl;
+}
+
+// ГБ/с - по несжатому объему (4 байта на число)
+void report(const std::string& name, double seconds, size_t values, double bits_per_value) {
+    std::cout << pad(name, 40, true) << pad(format(seconds * 1e3, 2), 10, false)
+              << pad(format(values / seconds / 1e6, 1), 14, false)
+              << pad(format(values * 4.0 / seconds / 1e9, 2), 8, false)
+              << pad(format(bits_per_value, 2), 12, false) << std::endl;
+}
+
+// Возрастающая последовательность с разностями из distribution
+template <typename Distribution>
+std::vector<uint32_t> ascending(size_t count, Distribution distribution, std::mt19937& random) {
+    std::vector<uint32_t> values(count);
+    uint32_t value = 0;
+    for (size_t i = 0; i < count; i++) {
+        value += distribution(random);
+        values[i] = value;
+    }
+    return values;
+}
+
+// Последовательность, сжатая по блокам BLOCK: у каждого блока разности
+// от последнего значения предыдущего
+struct Encoded {
+    std::vector<uint8_t> bytes;
+    size_t count = 0;
+};
+
+Encoded encode_blocks(posting_codec::Codec codec, const std::vector<uint32_t>& values) {
+    Encoded encoded;
+    encoded.count = values.size();
+    encoded.bytes.resize(posting_codec::max_encoded_size(values.size()) + posting_codec::PADDING);
+    std::vector<uint32_t> gaps;
+    size_t at = 0;
+    uint32_t base = 0;
+    for (size_t begin = 0; begin < values.size(); begin += BLOCK) {
+        size_t end = std::min(begin + BLOCK, values.size());
+        gaps.assign(values.begin() + begin, values.begin() + end);
+        posting_codec::delta_encode(gaps.data(), gaps.size(), base);
+        at += posting_codec::encode(codec, gaps.data(), gaps.size(), encoded.bytes.data() + at);
+        base = values[end - 1];
+    }
+    encoded.bytes.resize(at + posting_codec::PADDING);
+    return encoded;
+}
+
+uint64_t decode_blocks(posting_codec::Codec codec, const Encoded& encoded) {
+    uint32_t buffer[BLOCK];
+    const uint8_t* at = encoded.bytes.data();
+    uint32_t base = 0;
+    uint64_t sum = 0;
+    for (size_t begin = 0; begin < encoded.count; begin += BLOCK) {
+        size_t size = std::min(BLOCK, encoded.count - begin);
+        at += posting_codec::decode_deltas(codec, at, size, base, buffer);
+        base = buffer[size - 1];
+        for (size_t i = 0; i < size; i++) {
+            sum += buffer[i];
+        }
+    }
+    return sum;
+}
+
+uint64_t sum_raw(const std::vector<uint32_t>& values) {
+    uint64_t sum = 0;
+    for (uint32_t value : values) {
+        sum += value;
+    }
+    return sum;
+}
+
+bool bench_sequence(const std::string& name, const std::vector<uint32_t>& values) {
+    uint64_t expected = sum_raw(values);
+    bool ok = true;
+
+    std::string raw_name = name + ": несжатые";
+    if (selected(raw_name)) {
+        double seconds = measure([&] { sink = sum_raw(values); });
+        report(raw_name, seconds, values.size(), 32.0);
+    }
+
+    for (posting_codec::Codec codec : {posting_codec::Codec::VBYTE, posting_codec::Codec::STREAM_VBYTE}) {
+        std::string test_name = name + ": " + posting_codec::name(codec);
+        if (!selected(test_name)) {
+            continue;
+        }
+        Encoded encoded = encode_blocks(codec, values);
+        if (decode_blocks(codec, encoded) != expected) {
+            std::cout << test_name << ": распакованные значения не совпали с исходными" << std::endl;
+            ok = false;
+            continue;
+        }
+        double seconds = measure([&] { sink = decode_blocks(codec, encoded); });
+        double bits = 8.0 * (encoded.bytes.size() - posting_codec::PADDING) / values.size();
+        report(test_name, seconds, values.size(), bits);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = 1 << 24;  // 64 МБ несжатыми - больше кэша
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            min_time_sec = 0.05;
+            count = 1 << 22;
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::mt19937 random(2024);
+#if defined(__SSSE3__) || defined(__AVX2__)
+    std::cout << "Stream VByte: распаковка через SSSE3" << std::endl;
+#else
+    std::cout << "Stream VByte: распаковка без SIMD (сборка без SSSE3)" << std::endl;
+#endif
+    std::cout << "Чисел в последовательности: " << count << std::endl << std::endl;
+    print_header();
+
+    bool ok = true;
+    // Частый терм: встречается почти в каждом документе
+    ok &= bench_sequence("id документов, частый терм",
+                         ascending(count, std::uniform_int_distribution<uint32_t>(1, 3), random));
+    // Редкий терм: разности в тысячи документов (2 байта)
+    ok &= bench_sequence("id документов, редкий терм",
+                         ascending(count, std::geometric_distribution<uint32_t>(1.0 / 5000), random));
+    // Позиции: расстояния между вхождениями слова в тексте
+    ok &= bench_sequence("позиции",
+                         ascending(count, std::geometric_distribution<uint32_t>(1.0 / 60), random));
+    return ok ? 0 : 1;
+}
\ No newline at end of file
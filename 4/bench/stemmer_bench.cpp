@@ -0,0 +1,447 @@
+// Бенчмарк стеммера: скорость, выделения памяти и сверка с эталоном.
+//
+// Запуск: stemmer_bench [фильтр] [--quick] [--corpus=<путь>] [--golden=<файл>]
+//                       [--stem-table=<файл>] [--write-golden=<файл>] [--algorithm=snowball|simple]
+//   фильтр           - выполнять только тесты, в названии которых есть эта подстрока
+//   --quick          - короткие замеры (для быстрой проверки, менее точные)
+//   --corpus         - слова для замеров берутся из .txt файлов корпуса (поток
+//                      токенов, как при индексации: с повторами частых слов)
+//   --golden         - эталон "слово<TAB>основа": сверяются все пути стемминга
+//                      (правила, кэш, таблица основ); без --corpus его слова
+//                      служат и входными данными для замеров
+//   --stem-table     - таблица основ (build_stem_table), добавляет тест поиска по ней
+//   --write-golden   - записать эталон по словарю корпуса/эталона текущей
+//                      версией стеммера (алгоритм - --algorithm, по умолчанию snowball)
+//
+// Для каждого теста выводится лучшее время итерации, скорость в млн слов/с
+// и число выделений памяти (operator new) на слово. Расхождение с эталоном -
+// код возврата 1, так что изменение склейки словоформ не пройдет незамеченным.
+
+#include "stemmer.h"
+#include "token_scanner.h"
+#include "mapped_file.h"
+#include "utf8.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace fs = std::filesystem;
+
+// Счетчик выделений памяти: глобальный operator new заменен на
+// подсчитывающий (выровненные выделения - только в enable_cache, вне замеров)
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Не дает компилятору выбросить результаты замеряемого кода
+volatile size_t sink = 0;
+
+double min_time_sec = 0.5;
+std::string filter;
+
+const char* const GOLDEN_HEADER = "# stemmer_bench golden: algorithm=";
+const size_t MAX_REPORTED_MISMATCHES = 10;
+
+const char* algorithm_name(RussianStemmer::Algorithm algorithm) {
+    return algorithm == RussianStemmer::Algorithm::SNOWBALL ? "snowball" : "simple";
+}
+
+// Лучшее время одного вызова: прогревочный вызов, затем повторы,
+// пока суммарное время не превысит min_time_sec (не меньше трех повторов)
+template <typename Function>
+double measure(Function&& function) {
+    function();
+    double best = 1e100;
+    double total = 0.0;
+    size_t runs = 0;
+    while (total < min_time_sec || runs < 3) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        best = std::min(best, elapsed);
+        total += elapsed;
+        runs++;
+    }
+    return best;
+}
+
+// Выделений памяти за один (уже прогретый) вызов
+template <typename Function>
+size_t count_allocations(Function&& function) {
+    size_t before = allocation_count.load(std::memory_order_relaxed);
+    function();
+    return allocation_count.load(std::memory_order_relaxed) - before;
+}
+
+bool selected(const std::string& name) {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+// Дополняет строку пробелами до width символов (std::setw считает байты)
+std::string pad(const std::string& text, size_t width, bool left_align) {
+    size_t chars = utf8::length(text);
+    std::string padding(chars < width ? width - chars : 0, ' ');
+    return left_align ? text + padding : padding + text;
+}
+
+std::string format(double value, int precision) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+void print_header() {
+    std::cout << pad("Тест", 36, true) << pad("мкс/итер", 14, false)
+              << pad("млн слов/с", 14, false) << pad("аллок/слово", 14, false) << std::endl;
+    std::cout << std::string(78, '-') << std::endl;
+}
+
+void report(const std::string& name, double seconds, size_t words, size_t allocations) {
+    std::cout << pad(name, 36, true) << pad(format(seconds * 1e6, 1), 14, false)
+              << pad(format(words / seconds / 1e6, 2), 14, false)
+              << pad(format(double(allocations) / words, 3), 14, false) << std::endl;
+}
+
+// Поток слов для замеров: storage владеет байтами, words - виды в него
+struct WordStream {
+    std::string storage;
+    std::vector<std::string_view> words;
+};
+
+// Токены корпуса, отобранные так же, как при индексации
+void load_corpus(const std::string& path, WordStream& stream) {
+    std::vector<size_t> lengths;
+    for (const auto& entry : fs::directory_iterator(path)) {
+        if (entry.path().extension() != ".txt") {
+            continue;
+        }
+        MappedFile file;
+        if (!file.open(entry.path().string())) {
+            std::cerr << "Не удалось открыть файл: " << entry.path().string() << std::endl;
+            continue;
+        }
+        // Токен сканера живет до следующего next() - копируем
+        TokenScanner scanner(file.view());
+        std::string_view token;
+        while (scanner.next(token)) {
+            if (scanner.token_length() >= 2) {
+                stream.storage.append(token);
+                lengths.push_back(token.size());
+            }
+        }
+    }
+    // Виды создаются после заполнения storage (он мог переезжать)
+    size_t offset = 0;
+    stream.words.reserve(lengths.size());
+    for (size_t length : lengths) {
+        stream.words.emplace_back(stream.storage.data() + offset, length);
+        offset += length;
+    }
+}
+
+struct GoldenEntry {
+    std::string word;
+    std::string stem;
+};
+
+// Эталон: строка заголовка с алгоритмом, затем "слово<TAB>основа"
+bool read_golden(const std::string& path, std::string& algorithm, std::vector<GoldenEntry>& entries) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            if (line.compare(0, std::strlen(GOLDEN_HEADER), GOLDEN_HEADER) == 0) {
+                algorithm = line.substr(std::strlen(GOLDEN_HEADER));
+            }
+            continue;
+        }
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        entries.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+    return true;
+}
+
+bool write_golden(const std::string& path, RussianStemmer::Algorithm algorithm,
+                  const std::vector<std::string_view>& words) {
+    std::vector<std::string_view> vocabulary(words);
+    std::sort(vocabulary.begin(), vocabulary.end());
+    vocabulary.erase(std::unique(vocabulary.begin(), vocabulary.end()), vocabulary.end());
+
+    RussianStemmer stemmer(algorithm);
+    std::ofstream out(path, std::ios::binary);
+    out << GOLDEN_HEADER << algorithm_name(algorithm) << "\n";
+    for (std::string_view word : vocabulary) {
+        out << word << '\t' << word.substr(0, stemmer.stem_length(word)) << "\n";
+    }
+    std::cout << "Эталон записан в " << path << " (" << vocabulary.size() << " слов)" << std::endl;
+    return static_cast<bool>(out);
+}
+
+// Сверяет путь стемминга с эталоном; печатает первые расхождения
+size_t check_golden(const char* path_name, const RussianStemmer& stemmer,
+                    const std::vector<GoldenEntry>& golden) {
+    size_t mismatches = 0;
+    for (const GoldenEntry& entry : golden) {
+        std::string_view word = entry.word;
+        std::string_view stem = word.substr(0, stemmer.stem_length(word));
+        if (stem != entry.stem) {
+            if (mismatches < MAX_REPORTED_MISMATCHES) {
+                std::cout << "  [" << path_name << "] " << word << ": ожидалось "
+                          << entry.stem << ", получено " << stem << std::endl;
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void bench_algorithm(RussianStemmer::Algorithm algorithm, const WordStream& stream,
+                     const std::string& table_path) {
+    const std::vector<std::string_view>& words = stream.words;
+    std::string prefix = std::string("/") + algorithm_name(algorithm);
+
+    RussianStemmer stemmer(algorithm);
+    std::string name = "stem_length" + prefix + "/rules";
+    if (selected(name)) {
+        auto run = [&] {
+            size_t total = 0;
+            for (std::string_view word : words) {
+                total += stemmer.stem_length(word);
+            }
+            sink = sink + total;
+        };
+        double seconds = measure(run);
+        report(name, seconds, words.size(), count_allocations(run));
+    }
+
+    name = "stem_batch" + prefix;
+    if (selected(name)) {
+        std::vector<size_t> lengths(words.size());
+        auto run = [&] {
+            stemmer.stem_batch(words.data(), words.size(), lengths.data());
+            sink = sink + lengths.back();
+        };
+        double seconds = measure(run);
+        report(name, seconds, words.size(), count_allocations(run));
+    }
+
+    // stem() возвращает строку - для сравнения с путями без выделений
+    name = "stem_string" + prefix;
+    if (selected(name)) {
+        auto run = [&] {
+            size_t total = 0;
+            for (std::string_view word : words) {
+                total += stemmer.stem(word).size();
+            }
+            sink = sink + total;
+        };
+        double seconds = measure(run);
+        report(name, seconds, words.size(), count_allocations(run));
+    }
+
+    // Старый интерфейс: wstring на входе и на выходе
+    name = "stem_wstring" + prefix;
+    if (selected(name)) {
+        std::vector<std::wstring> wide_words;
+        wide_words.reserve(words.size());
+        for (std::string_view word : words) {
+            std::wstring wide;
+            for (size_t pos = 0; pos < word.size();) {
+                wide += static_cast<wchar_t>(utf8::decode(word.data(), word.size(), pos));
+            }
+            wide_words.push_back(std::move(wide));
+        }
+        auto run = [&] {
+            size_t total = 0;
+            for (const std::wstring& word : wide_words) {
+                total += stemmer.stem(word).size();
+            }
+            sink = sink + total;
+        };
+        double seconds = measure(run);
+        report(name, seconds, words.size(), count_allocations(run));
+    }
+
+    name = "stem_length" + prefix + "/cache";
+    if (selected(name)) {
+        RussianStemmer cached(algorithm);
+        cached.enable_cache(1 << 14);
+        auto run = [&] {
+            size_t total = 0;
+            for (std::string_view word : words) {
+                total += cached.stem_length(word);
+            }
+            sink = sink + total;
+        };
+        double seconds = measure(run);
+        report(name, seconds, words.size(), count_allocations(run));
+    }
+
+    name = "stem_length" + prefix + "/table";
+    if (!table_path.empty() && selected(name)) {
+        // Таблица другого алгоритма не подключится - тест пропускается
+        RussianStemmer tabled(algorithm);
+        if (tabled.load_table(table_path)) {
+            auto run = [&] {
+                size_t total = 0;
+                for (std::string_view word : words) {
+                    total += tabled.stem_length(word);
+                }
+                sink = sink + total;
+            };
+            double seconds = measure(run);
+            report(name, seconds, words.size(), count_allocations(run));
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string corpus_path;
+    std::string golden_path;
+    std::string table_path;
+    std::string write_golden_path;
+    RussianStemmer::Algorithm write_algorithm = RussianStemmer::Algorithm::SNOWBALL;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            min_time_sec = 0.05;
+        } else if (arg.rfind("--corpus=", 0) == 0) {
+            corpus_path = arg.substr(9);
+        } else if (arg.rfind("--golden=", 0) == 0) {
+            golden_path = arg.substr(9);
+        } else if (arg.rfind("--stem-table=", 0) == 0) {
+            table_path = arg.substr(13);
+        } else if (arg.rfind("--write-golden=", 0) == 0) {
+            write_golden_path = arg.substr(15);
+        } else if (arg == "--algorithm=simple") {
+            write_algorithm = RussianStemmer::Algorithm::SIMPLE;
+        } else if (arg == "--algorithm=snowball") {
+            write_algorithm = RussianStemmer::Algorithm::SNOWBALL;
+        } else {
+            filter = arg;
+        }
+    }
+
+    if (corpus_path.empty() && golden_path.empty()) {
+        std::cerr << "Использование: " << argv[0] << " [фильтр] [--quick] [--corpus=<путь>]"
+                  << " [--golden=<файл>] [--stem-table=<файл>] [--write-golden=<файл>]"
+                  << " [--algorithm=snowball|simple]" << std::endl;
+        std::cerr << "Пример: " << argv[0] << " --golden=4/bench/stemmer_golden.txt" << std::endl;
+        return 1;
+    }
+
+    std::string golden_algorithm;
+    std::vector<GoldenEntry> golden;
+    if (!golden_path.empty() && !read_golden(golden_path, golden_algorithm, golden)) {
+        std::cerr << "Не удалось открыть эталон: " << golden_path << std::endl;
+        return 1;
+    }
+    if (!golden_path.empty() && golden_algorithm != "simple" && golden_algorithm != "snowball") {
+        std::cerr << "В эталоне не указан алгоритм (строка \"" << GOLDEN_HEADER << "...\")" << std::endl;
+        return 1;
+    }
+
+    WordStream stream;
+    if (!corpus_path.empty()) {
+        if (!fs::exists(corpus_path)) {
+            std::cerr << "Ошибка: директория '" << corpus_path << "' не найдена!" << std::endl;
+            return 1;
+        }
+        load_corpus(corpus_path, stream);
+    } else {
+        for (const GoldenEntry& entry : golden) {
+            stream.words.emplace_back(entry.word);
+        }
+    }
+    if (stream.words.empty()) {
+        std::cerr << "Нет слов для замеров" << std::endl;
+        return 1;
+    }
+
+    if (!write_golden_path.empty()) {
+        return write_golden(write_golden_path, write_algorithm, stream.words) ? 0 : 1;
+    }
+
+    std::cout << "Слов в потоке: " << stream.words.size() << std::endl << std::endl;
+    print_header();
+    bench_algorithm(RussianStemmer::Algorithm::SIMPLE, stream, table_path);
+    bench_algorithm(RussianStemmer::Algorithm::SNOWBALL, stream, table_path);
+
+    if (golden.empty()) {
+        return 0;
+    }
+
+    // Сверка с эталоном: правила, кэш (второй проход - из кэша) и таблица
+    RussianStemmer::Algorithm algorithm = golden_algorithm == "simple"
+        ? RussianStemmer::Algorithm::SIMPLE : RussianStemmer::Algorithm::SNOWBALL;
+    std::cout << std::endl << "Сверка с эталоном " << golden_path << " ("
+              << golden.size() << " слов, " << algorithm_name(algorithm) << ")" << std::endl;
+
+    size_t mismatches = 0;
+    RussianStemmer rules(algorithm);
+    mismatches += check_golden("правила", rules, golden);
+
+    RussianStemmer cached(algorithm);
+    cached.enable_cache(1 << 14);
+    mismatches += check_golden("кэш", cached, golden);
+    mismatches += check_golden("кэш", cached, golden);
+
+    if (!table_path.empty()) {
+        RussianStemmer tabled(algorithm);
+        if (tabled.load_table(table_path)) {
+            mismatches += check_golden("таблица", tabled, golden);
+        } else {
+            std::cout << "  таблица " << table_path << " не подходит к эталону, пропущена" << std::endl;
+        }
+    }
+
+    if (mismatches != 0) {
+        std::cout << "Расхождений с эталоном: " << mismatches << std::endl;
+        return 1;
+    }
+    std::cout << "Расхождений нет" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <locale>
+#include "stemmer.h"
+#include "stem_table.h"
+#include "token_scanner.h"
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Построение таблицы основ: словарь корпуса стеммируется один раз,
+// результат записывается в файл, который indexer_with_stemming
+// отображает в память (--stem-table=<файл>) вместо повторного стемминга
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+#endif
+
+    std::locale::global(std::locale(""));
+
+    if (argc < 3) {
+        std::cerr << "Использование: " << argv[0] << " <путь_к_корпусу> <файл_таблицы> [snowball|simple]" << std::endl;
+        std::cerr << "Пример: " << argv[0] << " corpus_clean stems.bin" << std::endl;
+        return 1;
+    }
+
+    std::string corpus_path = argv[1];
+    std::string table_path = argv[2];
+
+    // По умолчанию - тот же алгоритм, что у индексатора
+    RussianStemmer::Algorithm algorithm = RussianStemmer::Algorithm::SNOWBALL;
+    if (argc > 3) {
+        std::string name = argv[3];
+        if (name == "simple") {
+            algorithm = RussianStemmer::Algorithm::SIMPLE;
+        } else if (name != "snowball") {
+            std::cerr << "Неизвестный алгоритм: " << name << " (ожидается snowball или simple)" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!fs::exists(corpus_path)) {
+        std::cerr << "Ошибка: директория '" << corpus_path << "' не найдена!" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Словарь корпуса: токены отбираются так же, как при индексации
+    std::unordered_set<std::string> vocabulary;
+    size_t file_count = 0;
+    for (const auto& entry : fs::directory_iterator(corpus_path)) {
+        if (entry.path().extension() != ".txt") {
+            continue;
+        }
+        MappedFile file;
+        if (!file.open(entry.path().string())) {
+            std::cerr << "Не удалось открыть файл: " << entry.path().string() << std::endl;
+            continue;
+        }
+        TokenScanner scanner(file.view());
+        std::string_view token;
+        while (scanner.next(token)) {
+            if (scanner.token_length() >= 2) {
+                vocabulary.emplace(token);
+            }
+        }
+        file_count++;
+    }
+
+    // Стемминг словаря; сортировка - чтобы файл не зависел от порядка хеша
+    RussianStemmer stemmer(algorithm);
+    std::vector<std::pair<std::string, size_t>> entries;
+    entries.reserve(vocabulary.size());
+    for (const auto& word : vocabulary) {
+        entries.emplace_back(word, stemmer.stem_length(std::string_view(word)));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    if (!StemTable::write(table_path, static_cast<uint32_t>(algorithm), entries)) {
+        std::cerr << "Не удалось записать таблицу: " << table_path << std::endl;
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Файлов: " << file_count << std::endl;
+    std::cout << "Слов в словаре: " << entries.size() << std::endl;
+    std::cout << "Таблица основ записана в " << table_path
+              << " (" << fs::file_size(table_path) << " байт)" << std::endl;
+    std::cout << "Время: " << std::chrono::duration<double>(end - start).count() << " секунд" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
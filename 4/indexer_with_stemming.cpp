@@ -11,7 +11,16 @@
 #include <cwctype>
 #include <algorithm>
 #include <cmath>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <charconv>
 #include "stemmer.h"
+#include "positional_index.h"
+#include "token_scanner.h"
+#include "mapped_file.h"
+#include "fnv1a.h"
+#include "utf8.h"
 
 // Добавьте эту строку
 #ifdef _WIN32
@@ -20,12 +29,7 @@
 
 namespace fs = std::filesystem;
 
-// Конвертер UTF-8 <-> wstring
-std::wstring utf8_to_wstring(const std::string& utf8) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.from_bytes(utf8);
-}
-
+// Конвертер wstring -> UTF-8 (для поиска по wide-строке)
 std::string wstring_to_utf8(const std::wstring& ws) {
     std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
     return converter.to_bytes(ws);
@@ -33,10 +37,17 @@ std::string wstring_to_utf8(const std::wstring& ws) {
 
 class IndexerWithStemming {
 private:
-    RussianStemmer stemmer;
+    // Snowball сводит больше словоформ к одной основе, чем простой
+    // список окончаний: словарь индекса меньше, списки длиннее
+    RussianStemmer stemmer{RussianStemmer::Algorithm::SNOWBALL};
     
-    // Инвертированный индекс: основа слова -> {документ_id -> {позиции}}
-    std::unordered_map<std::wstring, std::unordered_map<int, std::vector<int>>> index;
+    // Позиционный индекс, разбитый на шарды по хешу основы: при
+    // параллельном построении каждый шард пополняет ровно один поток,
+    // поэтому слияние идет без общей блокировки (см. positional_index.h)
+    static constexpr size_t SHARD_COUNT = 16;
+    std::vector<PositionalIndex> shards;
+    // Кодек сжатия постингов и позиций новых шардов
+    posting_codec::Codec codec = posting_codec::Codec::STREAM_VBYTE;
     
     // Метаданные документов
     std::unordered_map<int, std::string> doc_paths;
@@ -44,37 +55,397 @@ private:
     std::unordered_map<int, size_t> doc_token_counts;
     int next_doc_id = 1;
     
-    // Токенизация текста с поддержкой UTF-8
-    std::vector<std::wstring> tokenize(const std::wstring& text) {
-        std::vector<std::wstring> tokens;
-        std::wstring current_token;
-        
-        for (wchar_t c : text) {
-            // Используем функции из cwctype (глобальное пространство имен)
-            if (iswalnum(c) || 
-                (c >= L'а' && c <= L'я') || (c >= L'А' && c <= L'Я') ||
-                c == L'ё' || c == L'Ё' ||
-                c == L'-' || c == L'\'' || c == L'&') {
-                
-                current_token += towlower(c);
-            } else if (!current_token.empty()) {
-                // Проверяем минимальную длину токена
-                if (current_token.length() >= 2) {
-                    tokens.push_back(current_token);
+    size_t num_threads;
+    
+    // Двоичный файл индекса (save_binary_index/load_binary_index).
+    // Порядок байтов - как у машины, где файл записан:
+    //   IndexFileHeader
+    //   DocumentRecord[doc_count], за ними пути документов подряд
+    //   шарды (PositionalIndex::write), каждый с границы 8 байт
+    // Версия меняется при любом изменении формата, в том числе формата
+    // шарда или правила выбора шарда (shard_of)
+    static constexpr uint32_t INDEX_FORMAT_VERSION = 2;
+    
+    struct IndexFileHeader {
+        char magic[4];              // "SIDX"
+        uint32_t version;
+        uint32_t algorithm;         // RussianStemmer::Algorithm основ индекса
+        uint32_t shard_count;
+        uint32_t doc_count;
+        uint32_t next_doc_id;
+        uint64_t paths_offset;
+        uint64_t paths_size;
+        uint64_t shard_offsets[SHARD_COUNT];
+        uint64_t shard_sizes[SHARD_COUNT];
+    };
+    
+    struct DocumentRecord {
+        uint32_t doc_id;
+        uint32_t token_count;
+        uint64_t size;
+        uint64_t path_offset;       // От paths_offset
+        uint64_t path_length;
+    };
+    
+    // Отображение загруженного файла: шарды читают данные прямо из него
+    MappedFile index_file;
+    
+    // Документов в пачке: пачка разбирается параллельно, затем
+    // параллельно по шардам вливается в индекс. Ограничивает память
+    // под разобранные, но еще не влитые документы
+    static constexpr size_t BATCH_DOCUMENTS = 1024;
+    
+    // Вхождения одной основы в документ
+    struct StemEntry {
+        uint32_t term_id;           // id основы в словаре потока, разобравшего документ
+        uint32_t positions_offset;  // В ParsedDocument::positions
+        uint32_t frequency;
+    };
+    
+    // Результат разбора документа рабочим потоком: основы сгруппированы
+    // по шардам, внутри основы - позиции по возрастанию
+    struct ParsedDocument {
+        std::string path;
+        size_t size = 0;
+        size_t token_count = 0;
+        bool opened = false;
+        size_t worker = 0;                  // Чей словарь (WorkerBuffers::terms)
+        std::vector<StemEntry> entries;
+        std::vector<uint32_t> positions;
+        std::vector<uint32_t> shard_begin;  // Записи шарда s - [shard_begin[s], shard_begin[s + 1])
+    };
+    
+    // Состояние рабочего потока, переиспользуется между документами.
+    // Словарь потока (от него нужны только add_term/term) переводит
+    // основы в локальные id, чтобы группировать вхождения сортировкой
+    // чисел, а не строк; до конца слияния пачки он не меняется
+    struct WorkerBuffers {
+        std::string token_storage;
+        std::vector<size_t> stem_lengths;
+        PositionalIndex terms;
+        std::vector<uint8_t> term_shards;   // [локальный id] - шард основы
+        std::vector<uint64_t> occurrences;  // (локальный id << 32) | позиция
+        std::vector<StemEntry> grouped;
+    };
+    
+    // Младшие биты хеша адресуют слоты словаря шарда, поэтому шард
+    // выбирается по старшим
+    static size_t shard_of(std::string_view stem) {
+        return (fnv1a(stem) >> 16) % SHARD_COUNT;
+    }
+    
+    const PositionalIndex& shard_for(std::string_view stem) const {
+        return shards[shard_of(stem)];
+    }
+    
+    // Выполняет task(i, номер_потока) для i из [0, count) на num_threads
+    // потоках; поток 0 - вызывающий
+    template <typename Task>
+    void run_parallel(size_t count, Task&& task) {
+        size_t threads_count = std::min(num_threads, std::max<size_t>(count, 1));
+        std::atomic<size_t> next(0);
+        auto worker = [&](size_t thread_index) {
+            for (;;) {
+                size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count) {
+                    break;
                 }
-                current_token.clear();
+                task(i, thread_index);
             }
+        };
+        
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < threads_count; t++) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads) {
+            thread.join();
         }
+    }
+    
+    // Токенизация общим токенизатором (tokenizer_core): текст разбирается
+    // прямо в UTF-8, без wstring. Токен сканера живет только до следующего
+    // next(), поэтому токены копируются подряд в storage (одна строка на
+    // весь документ), а возвращаются срезы этой строки
+    static std::vector<std::string_view> tokenize(std::string_view text, std::string& storage) {
+        std::vector<size_t> ends;
+        storage.clear();
+        TokenScanner scanner(text);
+        std::string_view token;
         
-        // Последний токен
-        if (!current_token.empty() && current_token.length() >= 2) {
-            tokens.push_back(current_token);
+        while (scanner.next(token)) {
+            // Проверяем минимальную длину токена
+            if (scanner.token_length() >= 2) {
+                storage += token;
+                ends.push_back(storage.size());
+            }
         }
         
+        std::vector<std::string_view> tokens;
+        tokens.reserve(ends.size());
+        size_t start = 0;
+        for (size_t end : ends) {
+            tokens.push_back(std::string_view(storage).substr(start, end - start));
+            start = end;
+        }
         return tokens;
     }
     
+    // Разбор документа (в рабочем потоке): чтение, токенизация, стемминг
+    // и группировка позиций по основам. Общее состояние не меняет,
+    // кроме потокобезопасного кэша стеммера
+    void parse_document(const std::string& filepath, ParsedDocument& doc,
+                        WorkerBuffers& buffers, size_t worker) const {
+        doc.path = filepath;
+        doc.worker = worker;
+        doc.entries.clear();
+        doc.positions.clear();
+        doc.shard_begin.assign(SHARD_COUNT + 1, 0);
+        
+        // Файл отображается в память и токенизируется без копирования
+        MappedFile file;
+        doc.opened = file.open(filepath);
+        if (!doc.opened) {
+            return;
+        }
+        doc.size = file.get_size();
+        
+        // Токенизация
+        auto tokens = tokenize(file.view(), buffers.token_storage);
+        doc.token_count = tokens.size();
+        
+        // Стемминг одним пакетом: основа - начало токена, поэтому
+        // достаточно длин основ, сами основы - срезы того же текста
+        buffers.stem_lengths.resize(tokens.size());
+        stemmer.stem_batch(tokens.data(), tokens.size(), buffers.stem_lengths.data());
+        
+        // Сортировка пар (основа, позиция) группирует вхождения основы,
+        // позиции внутри группы остаются по возрастанию
+        buffers.occurrences.clear();
+        for (size_t pos = 0; pos < tokens.size(); ++pos) {
+            std::string_view stem = tokens[pos].substr(0, buffers.stem_lengths[pos]);
+            uint32_t term_id = buffers.terms.add_term(stem);
+            if (term_id == buffers.term_shards.size()) {
+                buffers.term_shards.push_back(static_cast<uint8_t>(shard_of(stem)));
+            }
+            buffers.occurrences.push_back((uint64_t(term_id) << 32) | uint32_t(pos));
+        }
+        std::sort(buffers.occurrences.begin(), buffers.occurrences.end());
+        
+        buffers.grouped.clear();
+        for (size_t i = 0; i < buffers.occurrences.size();) {
+            uint32_t term_id = static_cast<uint32_t>(buffers.occurrences[i] >> 32);
+            StemEntry entry{term_id, static_cast<uint32_t>(doc.positions.size()), 0};
+            for (; i < buffers.occurrences.size() && (buffers.occurrences[i] >> 32) == term_id; i++) {
+                doc.positions.push_back(static_cast<uint32_t>(buffers.occurrences[i]));
+                entry.frequency++;
+            }
+            buffers.grouped.push_back(entry);
+            doc.shard_begin[buffers.term_shards[term_id] + 1]++;
+        }
+        
+        // Раскладка записей по шардам (подсчетом)
+        for (size_t s = 0; s < SHARD_COUNT; s++) {
+            doc.shard_begin[s + 1] += doc.shard_begin[s];
+        }
+        doc.entries.resize(buffers.grouped.size());
+        std::vector<uint32_t> next(doc.shard_begin.begin(), doc.shard_begin.end() - 1);
+        for (const StemEntry& entry : buffers.grouped) {
+            doc.entries[next[buffers.term_shards[entry.term_id]]++] = entry;
+        }
+    }
+    
+    // Вливает записи шарда из разобранных документов пачки (в порядке doc_id)
+    void merge_shard(size_t shard, const std::vector<ParsedDocument>& batch,
+                     const std::vector<int>& batch_doc_ids, const std::vector<WorkerBuffers>& buffers) {
+        PositionalIndex& index = shards[shard];
+        for (size_t d = 0; d < batch.size(); d++) {
+            const ParsedDocument& doc = batch[d];
+            if (!doc.opened) {
+                continue;
+            }
+            const PositionalIndex& worker_terms = buffers[doc.worker].terms;
+            for (uint32_t e = doc.shard_begin[shard]; e < doc.shard_begin[shard + 1]; e++) {
+                const StemEntry& entry = doc.entries[e];
+                uint32_t term_id = index.add_term(worker_terms.term(entry.term_id));
+                index.add_postings(term_id, batch_doc_ids[d],
+                                   doc.positions.data() + entry.positions_offset, entry.frequency);
+            }
+        }
+    }
+    
+    // Разобранный запрос search_positional: основы фразы слева от NEAR
+    // и справа (right пуст, если NEAR нет)
+    struct PositionalQuery {
+        std::vector<std::string> left;
+        std::vector<std::string> right;
+        uint32_t distance = 0;
+    };
+    
+    // Основы слов операнда (кавычки - просто разделители)
+    std::vector<std::string> operand_stems(std::string_view operand) const {
+        std::string storage;
+        std::vector<std::string> stems;
+        for (std::string_view token : tokenize(operand, storage)) {
+            stems.emplace_back(token.substr(0, stemmer.stem_length(token)));
+        }
+        return stems;
+    }
+    
+    // false - запрос пуст или NEAR/k записан неверно (без числа, без
+    // операнда или больше одного раза)
+    bool parse_positional_query(const std::string& query_utf8, PositionalQuery& query) const {
+        const std::string near = "NEAR/";
+        size_t at = query_utf8.find(near);
+        if (at == std::string::npos) {
+            query.left = operand_stems(query_utf8);
+            return !query.left.empty();
+        }
+        
+        size_t digits = at + near.size();
+        size_t end = digits;
+        while (end < query_utf8.size() && query_utf8[end] >= '0' && query_utf8[end] <= '9') {
+            end++;
+        }
+        if (end == digits || end - digits > 6 || query_utf8.find(near, end) != std::string::npos) {
+            return false;
+        }
+        query.distance = static_cast<uint32_t>(std::stoul(query_utf8.substr(digits, end - digits)));
+        query.left = operand_stems(std::string_view(query_utf8).substr(0, at));
+        query.right = operand_stems(std::string_view(query_utf8).substr(end));
+        return !query.left.empty() && !query.right.empty() && query.distance > 0;
+    }
+    
+    // Первый элемент [first, last) не меньше target - галопом: шаги
+    // 1, 2, 4, ... от first, затем двоичный поиск в последнем шаге.
+    // Для монотонно растущих target это O(log расстояния), а не O(log n)
+    static const uint32_t* gallop(const uint32_t* first, const uint32_t* last, uint32_t target) {
+        size_t step = 1;
+        while (first < last && *first < target) {
+            const uint32_t* probe = last - first > static_cast<ptrdiff_t>(step) ? first + step : last;
+            if (probe == last || *probe >= target) {
+                return std::lower_bound(first + 1, probe, target);
+            }
+            first = probe;
+            step *= 2;
+        }
+        return first;
+    }
+    
+    // Начала вхождений фразы в текущий документ курсоров (все курсоры
+    // стоят на одном документе, слово i фразы - со сдвигом i). Перебираются
+    // позиции самого редкого в документе слова, позиции остальных
+    // догоняются галопом. ranges - рабочий массив (текущая и конечная
+    // позиция каждого слова), переиспользуется между документами
+    using PositionRange = std::pair<const uint32_t*, const uint32_t*>;
+    
+    static void match_phrase(PositionalIndex::Cursor* words, size_t count,
+                             std::vector<PositionRange>& ranges, std::vector<uint32_t>& starts) {
+        starts.clear();
+        ranges.resize(count);
+        size_t rarest = 0;
+        for (size_t i = 1; i < count; i++) {
+            if (words[i].frequency() < words[rarest].frequency()) {
+                rarest = i;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            ranges[i].first = words[i].positions();
+            ranges[i].second = ranges[i].first + words[i].frequency();
+        }
+        for (const uint32_t* anchor = ranges[rarest].first; anchor != ranges[rarest].second; anchor++) {
+            if (*anchor < rarest) {
+                continue;
+            }
+            uint32_t start = *anchor - static_cast<uint32_t>(rarest);
+            bool found = true;
+            for (size_t i = 0; i < count && found; i++) {
+                if (i == rarest) {
+                    continue;
+                }
+                auto& [head, end] = ranges[i];
+                head = gallop(head, end, start + static_cast<uint32_t>(i));
+                found = head != end && *head == start + i;
+            }
+            if (found) {
+                starts.push_back(start);
+            }
+        }
+    }
+    
+    // Сколько вхождений левой фразы (длины left_length) стоят рядом с
+    // вхождением правой: не пересекаются и между ними не больше distance
+    // позиций (конец одной и начало другой), в любом порядке
+    static size_t count_near(const std::vector<uint32_t>& left, size_t left_length,
+                             const std::vector<uint32_t>& right, size_t right_length, uint32_t distance) {
+        size_t matches = 0;
+        const uint32_t* head = right.data();
+        const uint32_t* end = right.data() + right.size();
+        for (uint32_t start : left) {
+            // Правые вхождения, начинающиеся в окне [lowest, highest]
+            int64_t lowest = int64_t(start) - distance - int64_t(right_length) + 1;
+            int64_t highest = int64_t(start) + int64_t(left_length) - 1 + distance;
+            head = gallop(head, end, static_cast<uint32_t>(std::max<int64_t>(lowest, 0)));
+            for (const uint32_t* at = head; at != end && *at <= highest; at++) {
+                bool before = int64_t(*at) + int64_t(right_length) <= start;
+                bool after = *at >= int64_t(start) + int64_t(left_length);
+                if (before || after) {
+                    matches++;
+                    break;
+                }
+            }
+        }
+        return matches;
+    }
+    
+    // Нормализация оценок по размеру документа и сортировка
+    // по релевантности (при равенстве - по id)
+    std::vector<int> rank_documents(std::vector<std::pair<int, double>> scored_docs) const {
+        for (auto& [doc_id, score] : scored_docs) {
+            auto it = doc_sizes.find(doc_id);
+            if (it != doc_sizes.end()) {
+                score /= (1.0 + std::log(it->second / 1024.0));
+            }
+        }
+        std::sort(scored_docs.begin(), scored_docs.end(),
+            [](const auto& a, const auto& b) {
+                return a.second != b.second ? a.second > b.second : a.first < b.first;
+            });
+        
+        std::vector<int> result;
+        for (const auto& [doc_id, score] : scored_docs) {
+            result.push_back(doc_id);
+        }
+        return result;
+    }
+    
 public:
+    // Кэш основ (1 МБ): по закону Ципфа нескольких тысяч самых
+    // частых слов хватает для подавляющего большинства токенов корпуса
+    static constexpr size_t STEM_CACHE_SIZE = 1 << 14;
+    
+    // num_threads = 0 - по числу ядер
+    explicit IndexerWithStemming(size_t num_threads = 0)
+        : shards(SHARD_COUNT),
+          num_threads(num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency())) {
+        stemmer.enable_cache(STEM_CACHE_SIZE);
+    }
+    
+    // Подключение таблицы основ, построенной build_stem_table
+    bool load_stem_table(const std::string& path) {
+        if (!stemmer.load_table(path)) {
+            return false;
+        }
+        std::cout << "Таблица основ: " << path << " (" << stemmer.table_size() << " слов)" << std::endl;
+        return true;
+    }
+    
+    // Кодек для индексации; загруженный индекс остается в своем
+    void set_posting_codec(posting_codec::Codec posting_codec) {
+        codec = posting_codec;
+    }
+    
     // Публичные методы для доступа к данным
     
     // Получение пути документа по ID
@@ -111,97 +482,220 @@ public:
     
     // Получение количества уникальных основ
     size_t get_unique_stems_count() const {
-        return index.size();
+        size_t count = 0;
+        for (const auto& shard : shards) {
+            count += shard.term_count();
+        }
+        return count;
     }
     
-
-
-    // Индексация документа
-    void index_document(const std::string& filepath) {
-        // Используем std::ifstream с широкими символами для Windows
-        std::ifstream file;
-        
-        #ifdef _WIN32
-        // Для Windows конвертируем путь в wstring
-        std::wstring wpath = utf8_to_wstring(filepath);
-        file.open(wpath.c_str(), std::ios::binary);
-        #else
-        // Для Linux/Unix
-        file.open(filepath.c_str(), std::ios::binary);
-        #endif
-        
-        if (!file) {
-            std::cerr << "Не удалось открыть файл: " << filepath << std::endl;
-            return;
+    // Память под данные индекса (всех шардов) в байтах
+    size_t get_index_memory_usage() const {
+        size_t bytes = 0;
+        for (const auto& shard : shards) {
+            bytes += shard.memory_usage();
         }
+        return bytes;
+    }
+    
+    // Сохранение индекса в двоичный файл; false при ошибке записи
+    bool save_binary_index(const std::string& filename) const {
+        std::vector<int> doc_ids;
+        doc_ids.reserve(doc_paths.size());
+        for (const auto& [doc_id, path] : doc_paths) {
+            doc_ids.push_back(doc_id);
+        }
+        std::sort(doc_ids.begin(), doc_ids.end());
         
-        // Чтение файла
-        file.seekg(0, std::ios::end);
-        size_t size = file.tellg();
-        std::string text(size, ' ');
-        file.seekg(0);
-        file.read(&text[0], size);
-        file.close();
-        
-        int doc_id = next_doc_id++;
-        doc_paths[doc_id] = filepath;
-        doc_sizes[doc_id] = size;
-        
-        // Конвертируем в wstring для обработки UTF-8
-        std::wstring wtext = utf8_to_wstring(text);
+        IndexFileHeader header{};
+        std::memcpy(header.magic, "SIDX", 4);
+        header.version = INDEX_FORMAT_VERSION;
+        header.algorithm = static_cast<uint32_t>(stemmer.get_algorithm());
+        header.shard_count = SHARD_COUNT;
+        header.doc_count = static_cast<uint32_t>(doc_ids.size());
+        header.next_doc_id = static_cast<uint32_t>(next_doc_id);
         
-        // Токенизация
-        auto tokens = tokenize(wtext);
-        doc_token_counts[doc_id] = tokens.size();
+        std::vector<DocumentRecord> records;
+        std::string paths;
+        for (int doc_id : doc_ids) {
+            const std::string& path = doc_paths.at(doc_id);
+            records.push_back({static_cast<uint32_t>(doc_id),
+                               static_cast<uint32_t>(get_document_token_count(doc_id)),
+                               get_document_size(doc_id), paths.size(), path.size()});
+            paths += path;
+        }
         
-        // Стемминг и индексация
-        std::unordered_map<std::wstring, std::vector<int>> word_positions;
+        // Смещения всех частей известны заранее
+        auto align8 = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+        header.paths_offset = sizeof(header) + records.size() * sizeof(DocumentRecord);
+        header.paths_size = paths.size();
+        uint64_t at = align8(header.paths_offset + paths.size());
+        for (size_t s = 0; s < SHARD_COUNT; s++) {
+            header.shard_offsets[s] = at;
+            header.shard_sizes[s] = shards[s].serialized_size();
+            at = align8(at + header.shard_sizes[s]);
+        }
         
-        for (size_t pos = 0; pos < tokens.size(); ++pos) {
-            std::wstring original = tokens[pos];
-            
-            // Применяем стемминг
-            std::wstring stemmed = stemmer.stem(original);
-            
-            // Сохраняем позицию для основы
-            word_positions[stemmed].push_back(pos);
+        std::ofstream out(filename, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(DocumentRecord));
+        out.write(paths.data(), paths.size());
+        uint64_t written = header.paths_offset + paths.size();
+        for (size_t s = 0; s < SHARD_COUNT; s++) {
+            static const char zeros[8] = {};
+            out.write(zeros, header.shard_offsets[s] - written);
+            if (!shards[s].write(out)) {
+                return false;
+            }
+            written = header.shard_offsets[s] + header.shard_sizes[s];
+        }
+        return static_cast<bool>(out);
+    }
+    
+    // Загрузка индекса, сохраненного save_binary_index: файл отображается
+    // в память, шарды используют его массивы на месте, разбирается только
+    // таблица документов. false (индекс не меняется), если файла нет,
+    // он поврежден, другой версии или посчитан другим алгоритмом стемминга.
+    // Вызывать вместо index_directory
+    bool load_binary_index(const std::string& filename) {
+        // Новый файл отображается отдельно: шарды текущего индекса
+        // указывают в index_file, и до конца проверок его трогать нельзя
+        MappedFile file;
+        if (!file.open(filename, MappedFile::Access::Random)) {
+            return false;
+        }
+        std::string_view data = file.view();
+        IndexFileHeader header;
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, "SIDX", 4) != 0 ||
+            header.version != INDEX_FORMAT_VERSION ||
+            header.algorithm != static_cast<uint32_t>(stemmer.get_algorithm()) ||
+            header.shard_count != SHARD_COUNT ||
+            header.doc_count > data.size() / sizeof(DocumentRecord) ||
+            header.paths_offset != sizeof(header) + uint64_t(header.doc_count) * sizeof(DocumentRecord) ||
+            header.paths_size > data.size() - header.paths_offset) {
+            return false;
+        }
+        for (size_t s = 0; s < SHARD_COUNT; s++) {
+            if (header.shard_offsets[s] > data.size() ||
+                header.shard_sizes[s] > data.size() - header.shard_offsets[s]) {
+                return false;
+            }
         }
         
-        // Добавляем в общий индекс
-        for (const auto& [stem, positions] : word_positions) {
-            index[stem][doc_id] = positions;
+        std::vector<PositionalIndex> loaded(SHARD_COUNT);
+        for (size_t s = 0; s < SHARD_COUNT; s++) {
+            if (!loaded[s].attach(data.data() + header.shard_offsets[s], header.shard_sizes[s])) {
+                return false;
+            }
         }
         
-        if (doc_id % 100 == 0) {
-            std::cout << "Проиндексирован документ #" << doc_id 
-                    << ": " << filepath 
-                    << " (токенов: " << tokens.size() << ")" << std::endl;
+        const char* records = data.data() + sizeof(header);
+        std::string_view paths = data.substr(header.paths_offset, header.paths_size);
+        std::unordered_map<int, std::string> loaded_paths;
+        std::unordered_map<int, size_t> loaded_sizes;
+        std::unordered_map<int, size_t> loaded_token_counts;
+        for (uint32_t i = 0; i < header.doc_count; i++) {
+            DocumentRecord record;
+            std::memcpy(&record, records + i * sizeof(DocumentRecord), sizeof(record));
+            if (record.path_offset > paths.size() || record.path_length > paths.size() - record.path_offset ||
+                record.doc_id >= header.next_doc_id) {
+                return false;
+            }
+            loaded_paths[record.doc_id] = std::string(paths.substr(record.path_offset, record.path_length));
+            loaded_sizes[record.doc_id] = record.size;
+            loaded_token_counts[record.doc_id] = record.token_count;
         }
+        
+        // Старое отображение освобождается вместе с file, после
+        // старых шардов (loaded)
+        index_file.swap(file);
+        shards.swap(loaded);
+        doc_paths.swap(loaded_paths);
+        doc_sizes.swap(loaded_sizes);
+        doc_token_counts.swap(loaded_token_counts);
+        next_doc_id = static_cast<int>(header.next_doc_id);
+        return true;
     }
     
-    // Индексация всех документов в директории
-    void index_directory(const std::string& dirpath, int limit = 0) {
-        std::cout << "Начало индексации с использованием стемминга..." << std::endl;
+    // Индексация всех документов в директории.
+    // Файлы упорядочиваются по имени, id документов назначаются в этом
+    // порядке - индекс не зависит ни от числа потоков, ни от порядка
+    // обхода директории
+    void index_directory(const std::string& dirpath, size_t limit = 0) {
+        std::cout << "Начало индексации с использованием стемминга (потоков: "
+                  << num_threads << ")..." << std::endl;
         auto start = std::chrono::high_resolution_clock::now();
         
+        std::vector<std::string> files;
+        for (const auto& entry : fs::directory_iterator(dirpath)) {
+            if (entry.path().extension() == ".txt") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        if (limit > 0 && files.size() > limit) {
+            files.resize(limit);
+        }
+        
         int file_count = 0;
         size_t total_tokens = 0;
         
-        for (const auto& entry : fs::directory_iterator(dirpath)) {
-            if (entry.path().extension() == ".txt") {
-                index_document(entry.path().string());
+        std::vector<WorkerBuffers> buffers(num_threads);
+        std::vector<ParsedDocument> batch;
+        std::vector<int> batch_doc_ids;
+        
+        for (size_t first = 0; first < files.size(); first += BATCH_DOCUMENTS) {
+            size_t count = std::min(BATCH_DOCUMENTS, files.size() - first);
+            batch.resize(count);
+            
+            // Разбор документов пачки
+            run_parallel(count, [&](size_t i, size_t thread_index) {
+                parse_document(files[first + i], batch[i], buffers[thread_index], thread_index);
+            });
+            
+            // id назначаются по порядку файлов
+            batch_doc_ids.assign(count, 0);
+            for (size_t i = 0; i < count; i++) {
+                const ParsedDocument& doc = batch[i];
+                if (!doc.opened) {
+                    std::cerr << "Не удалось открыть файл: " << doc.path << std::endl;
+                    continue;
+                }
+                int doc_id = next_doc_id++;
+                batch_doc_ids[i] = doc_id;
+                doc_paths[doc_id] = doc.path;
+                doc_sizes[doc_id] = doc.size;
+                doc_token_counts[doc_id] = doc.token_count;
                 file_count++;
                 
-                if (limit > 0 && file_count >= limit) {
-                    break;
+                if (doc_id % 100 == 0) {
+                    std::cout << "Проиндексирован документ #" << doc_id 
+                            << ": " << doc.path 
+                            << " (токенов: " << doc.token_count << ")" << std::endl;
                 }
-                
                 if (file_count % 100 == 0) {
                     std::cout << "Обработано файлов: " << file_count << std::endl;
                 }
             }
+            
+            // Слияние: шард пополняет только один поток
+            run_parallel(SHARD_COUNT, [&](size_t shard, size_t) {
+                merge_shard(shard, batch, batch_doc_ids, buffers);
+            });
         }
         
+        // Раскладка постингов по основам - часть построения индекса
+        run_parallel(SHARD_COUNT, [&](size_t shard, size_t) {
+            shards[shard].finalize(codec);
+        });
+        
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration<double>(end - start);
         
@@ -213,92 +707,196 @@ public:
         std::cout << "\nИндексация завершена!" << std::endl;
         std::cout << "Обработано документов: " << file_count << std::endl;
         std::cout << "Всего токенов: " << total_tokens << std::endl;
-        std::cout << "Уникальных основ: " << index.size() << std::endl;
+        std::cout << "Уникальных основ: " << get_unique_stems_count() << std::endl;
+        std::cout << "Память индекса: " << get_index_memory_usage() / (1024.0 * 1024.0) << " МБ" << std::endl;
         std::cout << "Время индексации: " << duration.count() << " секунд" << std::endl;
         std::cout << "Скорость: " << (file_count / duration.count()) << " документов/сек" << std::endl;
+        print_cache_statistics();
+    }
+    
+    // Статистика кэша основ
+    void print_cache_statistics() const {
+        auto stats = stemmer.cache_stats();
+        uint64_t lookups = stats.hits + stats.misses;
+        std::cout << "Кэш основ: попаданий " << stats.hits
+                  << ", промахов " << stats.misses
+                  << " (" << (lookups > 0 ? 100.0 * stats.hits / lookups : 0.0) << "% попаданий)"
+                  << ", вытеснено " << stats.evictions
+                  << ", слов в кэше " << stats.size << std::endl;
     }
     
     // Поиск документов по запросу
     std::vector<int> search(const std::wstring& query, bool use_stemming = true) {
-        std::vector<std::wstring> query_tokens = tokenize(query);
-        std::unordered_map<int, double> doc_scores;
+        return search_utf8(wstring_to_utf8(query), use_stemming);
+    }
+    
+    // Поиск документов по запросу в UTF-8
+    std::vector<int> search_utf8(const std::string& query_utf8, bool use_stemming = true) {
+        // Запрос разбирается тем же токенизатором, что и документы
+        std::string query_storage;
+        std::vector<std::string_view> query_tokens = tokenize(query_utf8, query_storage);
+        // Оценки - плоский массив по doc_id, found - документы с ненулевой оценкой
+        std::vector<double> doc_scores(next_doc_id, 0.0);
+        std::vector<int> found;
         
         for (const auto& token : query_tokens) {
-            std::wstring search_token = use_stemming ? stemmer.stem(token) : token;
+            std::string_view search_token = use_stemming ? token.substr(0, stemmer.stem_length(token)) : token;
             
-            if (index.find(search_token) != index.end()) {
-                for (const auto& [doc_id, positions] : index[search_token]) {
-                    // Более сложная оценка релевантности
-                    double score = positions.size(); // Количество вхождений
-                    
-                    // Бонус за точное совпадение (если не используется стемминг)
-                    if (!use_stemming) {
-                        score *= 1.2;
-                    }
-                    
-                    doc_scores[doc_id] += score;
+            const PositionalIndex& index = shard_for(search_token);
+            uint32_t term_id = index.find_term(search_token);
+            if (term_id == PositionalIndex::NONE) {
+                continue;
+            }
+            // Постинги терма распаковываются блоками по ходу прохода
+            for (auto posting = index.postings_of(term_id); posting.valid(); posting.next()) {
+                // Более сложная оценка релевантности
+                double score = posting.frequency(); // Количество вхождений
+                
+                // Бонус за точное совпадение (если не используется стемминг)
+                if (!use_stemming) {
+                    score *= 1.2;
                 }
+                
+                uint32_t doc_id = posting.doc_id();
+                if (doc_id >= doc_scores.size()) {
+                    continue;  // Только у поврежденного файла индекса
+                }
+                if (doc_scores[doc_id] == 0.0) {
+                    found.push_back(doc_id);
+                }
+                doc_scores[doc_id] += score;
             }
         }
         
-        // Нормализация по размеру документа
-        for (auto& [doc_id, score] : doc_scores) {
-            if (doc_sizes.find(doc_id) != doc_sizes.end()) {
-                score /= (1.0 + std::log(doc_sizes[doc_id] / 1024.0));
-            }
+        std::vector<std::pair<int, double>> scored_docs;
+        scored_docs.reserve(found.size());
+        for (int doc_id : found) {
+            scored_docs.emplace_back(doc_id, doc_scores[doc_id]);
+        }
+        return rank_documents(scored_docs);
+    }
+    
+    // Фразовые запросы и запросы на близость - по позициям слов:
+    //   "американский актёр"        - слова подряд и в этом порядке
+    //   актёр NEAR/3 фильм          - между словами не больше 3 позиций,
+    //                                 в любом порядке (соседние слова - 1)
+    //   "известный режиссёр" NEAR/5 фильм - операнды NEAR - фразы
+    // Несколько слов операнда (в кавычках или без) - тоже фраза. Оценка
+    // документа - число совпадений (вхождений фразы или левого операнда
+    // NEAR рядом с правым), нормированное по размеру, как в search_utf8
+    static bool is_positional_query(const std::string& query_utf8) {
+        return query_utf8.find('"') != std::string::npos || query_utf8.find("NEAR/") != std::string::npos;
+    }
+    
+    std::vector<int> search_positional(const std::string& query_utf8) {
+        PositionalQuery query;
+        if (!parse_positional_query(query_utf8, query)) {
+            return {};
         }
         
-        // Сортировка документов по релевантности
-        std::vector<std::pair<int, double>> sorted_docs(doc_scores.begin(), doc_scores.end());
-        std::sort(sorted_docs.begin(), sorted_docs.end(),
-            [](const auto& a, const auto& b) { return a.second > b.second; });
+        // Курсоры всех слов запроса: сначала левого операнда, потом правого
+        std::vector<PositionalIndex::Cursor> cursors;
+        cursors.reserve(query.left.size() + query.right.size());
+        for (const auto* operand : {&query.left, &query.right}) {
+            for (const std::string& stem : *operand) {
+                const PositionalIndex& index = shard_for(stem);
+                uint32_t term_id = index.find_term(stem);
+                if (term_id == PositionalIndex::NONE) {
+                    return {};  // Слова нет в корпусе - совпадений нет
+                }
+                cursors.push_back(index.postings_of(term_id));
+            }
+        }
         
-        std::vector<int> result;
-        for (const auto& [doc_id, score] : sorted_docs) {
-            result.push_back(doc_id);
+        // Пересечение списков документов: самый короткий список задает
+        // кандидата, остальные догоняют его через advance_to (пропуская
+        // блоки постингов, не распаковывая их)
+        std::vector<PositionalIndex::Cursor*> by_size;
+        for (auto& cursor : cursors) {
+            by_size.push_back(&cursor);
         }
+        std::sort(by_size.begin(), by_size.end(),
+            [](const auto* a, const auto* b) { return a->size() < b->size(); });
         
-        return result;
-    }
-    
-    // Поиск документов по запросу в UTF-8
-    std::vector<int> search_utf8(const std::string& query_utf8, bool use_stemming = true) {
-        std::wstring query = utf8_to_wstring(query_utf8);
-        return search(query, use_stemming);
+        std::vector<std::pair<int, double>> scored_docs;
+        std::vector<uint32_t> left_starts;
+        std::vector<uint32_t> right_starts;
+        std::vector<PositionRange> ranges;
+        PositionalIndex::Cursor* lead = by_size[0];
+        while (lead->valid()) {
+            uint32_t candidate = lead->doc_id();
+            bool aligned = true;
+            for (size_t i = 1; i < by_size.size() && aligned; i++) {
+                by_size[i]->advance_to(candidate);
+                if (!by_size[i]->valid()) {
+                    return rank_documents(scored_docs);
+                }
+                if (by_size[i]->doc_id() != candidate) {
+                    lead->advance_to(by_size[i]->doc_id());
+                    aligned = false;
+                }
+            }
+            if (!aligned) {
+                continue;
+            }
+            
+            // Все слова есть в документе - сверяются позиции
+            size_t left_count = query.left.size();
+            match_phrase(cursors.data(), left_count, ranges, left_starts);
+            size_t matches = left_starts.size();
+            if (!query.right.empty() && matches > 0) {
+                match_phrase(cursors.data() + left_count, query.right.size(), ranges, right_starts);
+                matches = count_near(left_starts, left_count, right_starts, query.right.size(), query.distance);
+            }
+            if (matches > 0) {
+                scored_docs.emplace_back(candidate, static_cast<double>(matches));
+            }
+            lead->next();
+        }
+        return rank_documents(scored_docs);
     }
     
     // Статистика индекса
     void print_statistics() {
         size_t total_postings = 0;
+        for (const auto& shard : shards) {
+            total_postings += shard.position_count();
+        }
         size_t total_docs = doc_paths.size();
         size_t total_tokens = 0;
         
-        for (const auto& [stem, doc_map] : index) {
-            for (const auto& [doc_id, positions] : doc_map) {
-                total_postings += positions.size();
-            }
-        }
-        
         for (const auto& [doc_id, count] : doc_token_counts) {
             total_tokens += count;
         }
         
-        double avg_postings_per_word = index.empty() ? 0 : (double)total_postings / index.size();
+        size_t term_count = get_unique_stems_count();
+        double avg_postings_per_word = term_count == 0 ? 0 : (double)total_postings / term_count;
         
         std::cout << "\nСтатистика индекса:" << std::endl;
         std::cout << "==================" << std::endl;
         std::cout << "Документов: " << total_docs << std::endl;
         std::cout << "Всего токенов: " << total_tokens << std::endl;
-        std::cout << "Уникальных основ: " << index.size() << std::endl;
+        std::cout << "Уникальных основ: " << term_count << std::endl;
         std::cout << "Всего постингов: " << total_postings << std::endl;
         std::cout << "Среднее постингов на основу: " << avg_postings_per_word << std::endl;
         
-        if (!index.empty()) {
+        // Сжатые списки: разности id и позиций кодом переменной длины
+        size_t encoded_bytes = 0;
+        for (const auto& shard : shards) {
+            encoded_bytes += shard.encoded_size();
+        }
+        std::cout << "Сжатые постинги и позиции (" << posting_codec::name(shards[0].codec()) << "): "
+                  << encoded_bytes / (1024.0 * 1024.0) << " МБ, "
+                  << (total_postings == 0 ? 0.0 : 8.0 * encoded_bytes / total_postings) << " бит на позицию" << std::endl;
+        
+        if (term_count > 0) {
             double total_length = 0;
-            for (const auto& [stem, _] : index) {
-                total_length += stem.length();
+            for (const auto& shard : shards) {
+                for (uint32_t term_id = 0; term_id < shard.term_count(); term_id++) {
+                    total_length += utf8::length(shard.term(term_id));
+                }
             }
-            std::cout << "Средняя длина основы: " << (total_length / index.size()) 
+            std::cout << "Средняя длина основы: " << (total_length / term_count) 
                       << " символов" << std::endl;
         } else {
             std::cout << "Средняя длина основы: 0" << std::endl;
@@ -371,6 +969,42 @@ public:
         }
     }
     
+    // Фразовые запросы и запросы на близость против поиска по тем же
+    // словам без учета позиций
+    void evaluate_positional_queries() {
+        std::cout << "\nФразовые запросы и запросы на близость:" << std::endl;
+        std::cout << "=======================================" << std::endl;
+        
+        struct TestQuery {
+            std::string query_utf8;
+            std::string words_utf8;  // Те же слова для обычного поиска
+        };
+        
+        std::vector<TestQuery> test_queries = {
+            {"\"американский актёр\"", "американский актёр"},
+            {"\"американский режиссёр\"", "американский режиссёр"},
+            {"\"лучший фильм\"", "лучший фильм"},
+            {"актёр NEAR/3 фильм", "актёр фильм"},
+            {"оскар NEAR/1 режиссёр", "оскар режиссёр"},
+            {"\"американский актёр\" NEAR/5 оскар", "американский актёр оскар"}
+        };
+        
+        for (const auto& test : test_queries) {
+            auto words_results = search_utf8(test.words_utf8, true);
+            auto start = std::chrono::high_resolution_clock::now();
+            auto results = search_positional(test.query_utf8);
+            auto end = std::chrono::high_resolution_clock::now();
+            
+            std::cout << "\nЗапрос: " << test.query_utf8 << std::endl;
+            std::cout << "  По словам: " << words_results.size() << " документов, по позициям: "
+                      << results.size() << " ("
+                      << std::chrono::duration<double, std::micro>(end - start).count() << " мкс)" << std::endl;
+            for (size_t i = 0; i < std::min<size_t>(3, results.size()); i++) {
+                std::cout << "    " << (i + 1) << ". " << get_document_path(results[i]) << std::endl;
+            }
+        }
+    }
+    
     // Анализ проблем стемминга
     void analyze_stemming_problems() {
         std::cout << "\nАнализ проблем стемминга:" << std::endl;
@@ -387,9 +1021,8 @@ public:
         
         std::cout << "Проблема омонимов:" << std::endl;
         for (const auto& word_utf8 : homonyms_utf8) {
-            std::wstring word = utf8_to_wstring(word_utf8);
-            std::wstring stemmed = stemmer.stem(word);
-            std::cout << "  " << word_utf8 << " -> " << wstring_to_utf8(stemmed) 
+            std::string stemmed = stemmer.stem(word_utf8);
+            std::cout << "  " << word_utf8 << " -> " << stemmed 
                       << " (потеря смысла)" << std::endl;
         }
         
@@ -403,14 +1036,11 @@ public:
         std::cout << "\nПроблема перестемминга:" << std::endl;
         for (size_t i = 0; i < overstemming_examples_utf8.size(); i += 2) {
             if (i + 1 < overstemming_examples_utf8.size()) {
-                std::wstring word1 = utf8_to_wstring(overstemming_examples_utf8[i]);
-                std::wstring word2 = utf8_to_wstring(overstemming_examples_utf8[i + 1]);
-                
-                std::wstring stem1 = stemmer.stem(word1);
-                std::wstring stem2 = stemmer.stem(word2);
+                std::string stem1 = stemmer.stem(overstemming_examples_utf8[i]);
+                std::string stem2 = stemmer.stem(overstemming_examples_utf8[i + 1]);
                 
-                std::cout << "  " << overstemming_examples_utf8[i] << " -> " << wstring_to_utf8(stem1)
-                          << ", " << overstemming_examples_utf8[i + 1] << " -> " << wstring_to_utf8(stem2);
+                std::cout << "  " << overstemming_examples_utf8[i] << " -> " << stem1
+                          << ", " << overstemming_examples_utf8[i + 1] << " -> " << stem2;
                 
                 if (stem1 == stem2) {
                     std::cout << " (слишком агрессивно)" << std::endl;
@@ -424,7 +1054,7 @@ public:
         std::cout << "\nРекомендации по улучшению:" << std::endl;
         std::cout << "1. Использовать словарь исключений для частых омонимов" << std::endl;
         std::cout << "2. Добавить контекстный анализ для определения части речи" << std::endl;
-        std::cout << "3. Использовать более сложные алгоритмы (Snowball, Porter2)" << std::endl;
+        std::cout << "3. Использовать лемматизацию (словарь словоформ) вместо стемминга" << std::endl;
         std::cout << "4. Комбинировать стемминг с n-граммами" << std::endl;
         std::cout << "5. Реализовать откат к оригинальному слову при низкой уверенности" << std::endl;
     }
@@ -447,25 +1077,30 @@ public:
             }
             return total;
         }() << "\n";
-        file << "Уникальных основ: " << index.size() << "\n\n";
+        file << "Уникальных основ: " << get_unique_stems_count() << "\n\n";
         
         file << "Топ-50 самых частых основ:\n";
-        std::vector<std::pair<std::wstring, size_t>> stem_freq;
+        std::vector<std::pair<std::string, size_t>> stem_freq;
         
-        for (const auto& [stem, doc_map] : index) {
-            size_t total_positions = 0;
-            for (const auto& [doc_id, positions] : doc_map) {
-                total_positions += positions.size();
+        for (const auto& shard : shards) {
+            for (uint32_t term_id = 0; term_id < shard.term_count(); term_id++) {
+                size_t total_positions = 0;
+                for (auto posting = shard.postings_of(term_id); posting.valid(); posting.next()) {
+                    total_positions += posting.frequency();
+                }
+                stem_freq.emplace_back(shard.term(term_id), total_positions);
             }
-            stem_freq.emplace_back(stem, total_positions);
         }
         
-        // Сортировка по частоте
+        // Сортировка по частоте (при равенстве - по основе, чтобы порядок
+        // не зависел от раскладки по шардам)
         std::sort(stem_freq.begin(), stem_freq.end(),
-            [](const auto& a, const auto& b) { return a.second > b.second; });
+            [](const auto& a, const auto& b) {
+                return a.second != b.second ? a.second > b.second : a.first < b.first;
+            });
         
         for (size_t i = 0; i < std::min(stem_freq.size(), (size_t)50); i++) {
-            file << i+1 << ". " << wstring_to_utf8(stem_freq[i].first) 
+            file << i+1 << ". " << stem_freq[i].first 
                  << " - " << stem_freq[i].second << " вхождений\n";
         }
         
@@ -474,6 +1109,22 @@ public:
     }
 };
 
+// Тесты подключают этот файл ради класса IndexerWithStemming
+#ifndef INDEXER_NO_MAIN
+
+// Неотрицательное целое из аргумента командной строки целиком;
+// false, если это не число или оно не помещается в size_t
+static bool parse_count(const std::string& text, size_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+static void print_usage(const char* program) {
+    std::cerr << "Использование: " << program << " <путь_к_корпусу> [лимит_документов] [--stem-table=<файл>] [--threads=N] [--index=<файл>] [--codec=stream-vbyte|vbyte]" << std::endl;
+    std::cerr << "Пример: " << program << " corpus_clean 1000" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
      // Настройка кодировки для Windows
     #ifdef _WIN32
@@ -488,39 +1139,104 @@ int main(int argc, char* argv[]) {
     std::cout << "=====================================================" << std::endl;
     
     if (argc < 2) {
-        std::cerr << "Использование: " << argv[0] << " <путь_к_корпусу> [лимит_документов]" << std::endl;
-        std::cerr << "Пример: " << argv[0] << " corpus_clean 1000" << std::endl;
+        print_usage(argv[0]);
         return 1;
     }
     
     std::string corpus_path = argv[1];
-    int limit = 0;
-    
-    if (argc > 2) {
-        limit = std::stoi(argv[2]);
-    }
     
-    // Проверка существования корпуса
-    if (!fs::exists(corpus_path)) {
-        std::cerr << "Ошибка: директория '" << corpus_path << "' не найдена!" << std::endl;
-        return 1;
+    // [лимит_документов]: число без флага, 0 - без ограничения
+    // --stem-table=<файл>: заранее посчитанные основы (build_stem_table)
+    // --threads=N: потоков индексации (по умолчанию - по числу ядер)
+    // --index=<файл>: двоичный индекс; если файл есть, он загружается
+    // вместо индексации корпуса, иначе индекс строится и сохраняется в него
+    // --codec=stream-vbyte|vbyte: сжатие постингов и позиций при индексации
+    size_t limit = 0;
+    std::string stem_table;
+    std::string index_path;
+    size_t num_threads = 0;
+    posting_codec::Codec codec = posting_codec::Codec::STREAM_VBYTE;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--stem-table=", 0) == 0) {
+            stem_table = arg.substr(std::string("--stem-table=").size());
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            std::string value = arg.substr(std::string("--threads=").size());
+            if (!parse_count(value, num_threads)) {
+                std::cerr << "Неверное число потоков: '" << value << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--index=", 0) == 0) {
+            index_path = arg.substr(std::string("--index=").size());
+        } else if (arg == "--codec=vbyte") {
+            codec = posting_codec::Codec::VBYTE;
+        } else if (arg == "--codec=stream-vbyte") {
+            codec = posting_codec::Codec::STREAM_VBYTE;
+        } else if (arg.rfind("--", 0) == 0) {
+            // Опечатка в параметре не должна молча давать другой индекс
+            std::cerr << "Неизвестный параметр: '" << arg << "'" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        } else if (!parse_count(arg, limit)) {
+            std::cerr << "Неверный лимит документов: '" << arg << "'" << std::endl;
+            return 1;
+        }
     }
     
-    // Тестирование стеммера
-    RussianStemmer stemmer;
+    // Тестирование стеммера - тем же алгоритмом, что и при индексации
+    RussianStemmer stemmer(RussianStemmer::Algorithm::SNOWBALL);
     std::cout << "\n1. Тестирование стеммера:" << std::endl;
     stemmer.test();
     
-    // Индексация корпуса
-    IndexerWithStemming indexer;
-    std::cout << "\n2. Индексация корпуса:" << std::endl;
-    indexer.index_directory(corpus_path, limit);
+    IndexerWithStemming indexer(num_threads);
+    indexer.set_posting_codec(codec);
+    if (!stem_table.empty() && !indexer.load_stem_table(stem_table)) {
+        std::cerr << "Не удалось загрузить таблицу основ '" << stem_table
+                  << "' (нет файла или посчитана другим алгоритмом), основы считаются заново" << std::endl;
+    }
+    
+    // Готовый двоичный индекс: загрузка вместо индексации
+    bool loaded = false;
+    if (!index_path.empty() && fs::exists(index_path)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        loaded = indexer.load_binary_index(index_path);
+        auto end = std::chrono::high_resolution_clock::now();
+        if (loaded) {
+            std::cout << "\n2. Индекс загружен из " << index_path << " за "
+                      << std::chrono::duration<double, std::milli>(end - start).count() << " мс ("
+                      << indexer.get_document_count() << " документов)" << std::endl;
+        } else {
+            std::cerr << "Файл '" << index_path << "' не подходит (поврежден, другая версия формата"
+                      << " или другой стеммер), индекс будет построен заново" << std::endl;
+        }
+    }
+    
+    if (!loaded) {
+        // Проверка существования корпуса
+        if (!fs::exists(corpus_path)) {
+            std::cerr << "Ошибка: директория '" << corpus_path << "' не найдена!" << std::endl;
+            return 1;
+        }
+        
+        // Индексация корпуса
+        std::cout << "\n2. Индексация корпуса:" << std::endl;
+        indexer.index_directory(corpus_path, limit);
+        
+        if (!index_path.empty()) {
+            if (indexer.save_binary_index(index_path)) {
+                std::cout << "Двоичный индекс сохранен в " << index_path << std::endl;
+            } else {
+                std::cerr << "Не удалось сохранить двоичный индекс в " << index_path << std::endl;
+            }
+        }
+    }
     
     // Статистика индекса
     indexer.print_statistics();
     
     // Оценка качества поиска
     indexer.evaluate_search_quality();
+    indexer.evaluate_positional_queries();
     
     // Анализ проблем
     indexer.analyze_stemming_problems();
@@ -530,6 +1246,7 @@ int main(int argc, char* argv[]) {
     
     // Пример интерактивного поиска
     std::cout << "\n3. Интерактивный поиск (для выхода введите 'exit'):" << std::endl;
+    std::cout << "   фраза - в кавычках: \"американский актёр\", близость - актёр NEAR/3 фильм" << std::endl;
     
     std::string input;
     std::cin.ignore(); // Очищаем буфер ввода
@@ -542,7 +1259,9 @@ int main(int argc, char* argv[]) {
             break;
         }
         
-        auto results = indexer.search_utf8(input, true);
+        auto results = IndexerWithStemming::is_positional_query(input)
+            ? indexer.search_positional(input)
+            : indexer.search_utf8(input, true);
         
         std::cout << "Найдено документов: " << results.size() << std::endl;
         
@@ -559,4 +1278,6 @@ int main(int argc, char* argv[]) {
     std::cout << "\nРабота завершена. Результаты сохранены в stemming_index.txt" << std::endl;
     
     return 0;
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,510 @@
+#include "positional_index.h"
+#include "fnv1a.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'P', 'I', 'X', '2'};
+
+size_t align8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+// Смещения массивов в записи write() (от начала заголовка)
+struct Layout {
+    size_t term_text;
+    size_t term_offsets;
+    size_t term_hashes;
+    size_t slots;
+    size_t posting_offsets;
+    size_t block_offsets;
+    size_t blocks;
+    size_t data;
+    size_t end;
+};
+
+Layout layout_of(const PositionalIndex::FileHeader& header) {
+    Layout layout;
+    size_t at = align8(sizeof(PositionalIndex::FileHeader));
+    layout.term_text = at;
+    at = align8(at + header.term_text_size);
+    layout.term_offsets = at;
+    at = align8(at + (size_t(header.term_count) + 1) * sizeof(uint32_t));
+    layout.term_hashes = at;
+    at = align8(at + size_t(header.term_count) * sizeof(uint32_t));
+    layout.slots = at;
+    at = align8(at + size_t(header.slot_count) * sizeof(uint32_t));
+    layout.posting_offsets = at;
+    at = align8(at + (size_t(header.term_count) + 1) * sizeof(uint32_t));
+    layout.block_offsets = at;
+    at = align8(at + (size_t(header.term_count) + 1) * sizeof(uint32_t));
+    layout.blocks = at;
+    at = align8(at + header.block_count * sizeof(PositionalIndex::Block));
+    layout.data = at;
+    layout.end = align8(at + header.data_size);
+    return layout;
+}
+
+} // namespace
+
+PositionalIndex::PositionalIndex()
+    : term_offsets(1, 0), slots(1024, 0), data_codec(posting_codec::Codec::STREAM_VBYTE),
+      total_positions(0), finalized(false) {
+    refresh_view();
+}
+
+void PositionalIndex::refresh_view() {
+    view.term_text = term_text.data();
+    view.term_offsets = term_offsets.data();
+    view.term_hashes = term_hashes.data();
+    view.slots = slots.data();
+    view.posting_offsets = posting_offsets.data();
+    view.block_offsets = block_offsets.data();
+    view.blocks = blocks.data();
+    view.data = data.data();
+    view.term_count = static_cast<uint32_t>(term_hashes.size());
+    view.slot_count = static_cast<uint32_t>(slots.size());
+    view.term_text_size = term_text.size();
+    // До finalize счетчики - по еще не сжатым постингам
+    view.posting_count = finalized ? posting_offsets.back() : postings.size();
+    view.position_count = finalized ? total_positions : positions.size();
+    view.block_count = blocks.size();
+    view.data_size = data.size();
+    view.codec = data_codec;
+}
+
+// Слот с этим термом или пустой слот, куда его можно вставить
+uint32_t PositionalIndex::find_slot(std::string_view term, uint32_t hash) const {
+    uint32_t mask = view.slot_count - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        uint32_t slot = view.slots[i];
+        if (slot == 0) {
+            return i;
+        }
+        uint32_t id = slot - 1;
+        if (view.term_hashes[id] == hash && this->term(id) == term) {
+            return i;
+        }
+    }
+}
+
+void PositionalIndex::grow_slots() {
+    std::vector<uint32_t> grown(slots.size() * 2, 0);
+    uint32_t mask = static_cast<uint32_t>(grown.size() - 1);
+    for (uint32_t id = 0; id < term_hashes.size(); id++) {
+        uint32_t i = term_hashes[id] & mask;
+        while (grown[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        grown[i] = id + 1;
+    }
+    slots.swap(grown);
+}
+
+uint32_t PositionalIndex::add_term(std::string_view term) {
+    uint32_t hash = fnv1a(term);
+    uint32_t i = find_slot(term, hash);
+    if (view.slots[i] != 0) {
+        return view.slots[i] - 1;
+    }
+
+    uint32_t id = static_cast<uint32_t>(term_hashes.size());
+    term_text.append(term);
+    term_offsets.push_back(static_cast<uint32_t>(term_text.size()));
+    term_hashes.push_back(hash);
+    slots[i] = id + 1;
+    // Заполнение не больше половины: пробы короткие
+    if (term_hashes.size() * 2 > slots.size()) {
+        grow_slots();
+    }
+    refresh_view();
+    return id;
+}
+
+uint32_t PositionalIndex::find_term(std::string_view term) const {
+    uint32_t slot = view.slots[find_slot(term, fnv1a(term))];
+    return slot != 0 ? slot - 1 : NONE;
+}
+
+std::string_view PositionalIndex::term(uint32_t term_id) const {
+    return std::string_view(view.term_text + view.term_offsets[term_id],
+                            view.term_offsets[term_id + 1] - view.term_offsets[term_id]);
+}
+
+void PositionalIndex::add_postings(uint32_t term_id, uint32_t doc_id,
+                                   const uint32_t* term_positions, size_t count) {
+    postings.push_back(Posting{doc_id, static_cast<uint32_t>(count), static_cast<uint32_t>(positions.size())});
+    positions.insert(positions.end(), term_positions, term_positions + count);
+    pending_terms.push_back(term_id);
+    refresh_view();
+}
+
+void PositionalIndex::finalize(posting_codec::Codec codec) {
+    if (finalized) {
+        return;
+    }
+    finalized = true;
+    data_codec = codec;
+    total_positions = positions.size();
+
+    // Сортировка подсчетом по терму: устойчивая, поэтому внутри терма
+    // постинги остаются по возрастанию документов
+    posting_offsets.assign(term_count() + 1, 0);
+    for (uint32_t term_id : pending_terms) {
+        posting_offsets[term_id + 1]++;
+    }
+    for (size_t t = 0; t < term_count(); t++) {
+        posting_offsets[t + 1] += posting_offsets[t];
+    }
+
+    std::vector<uint32_t> next(posting_offsets.begin(), posting_offsets.end() - 1);
+    std::vector<Posting> by_term(postings.size());
+    for (size_t i = 0; i < postings.size(); i++) {
+        by_term[next[pending_terms[i]]++] = postings[i];
+    }
+    std::vector<Posting>().swap(postings);
+    std::vector<uint32_t>().swap(pending_terms);
+
+    // Блоки по BLOCK_SIZE постингов: код разностей doc_id (первая - от
+    // последнего doc_id предыдущего блока терма), сразу за ним код
+    // частот, отдельно - код позиций, у каждого постинга разности от нуля
+    block_offsets.assign(term_count() + 1, 0);
+    blocks.clear();
+    data.clear();
+    std::vector<uint32_t> values;
+    auto append = [&](const std::vector<uint32_t>& block_values) {
+        size_t at = data.size();
+        data.resize(at + posting_codec::max_encoded_size(block_values.size()));
+        data.resize(at + posting_codec::encode(codec, block_values.data(), block_values.size(), data.data() + at));
+    };
+
+    for (size_t t = 0; t < term_count(); t++) {
+        uint32_t previous_doc_id = 0;
+        for (uint32_t begin = posting_offsets[t]; begin < posting_offsets[t + 1]; begin += BLOCK_SIZE) {
+            uint32_t end = std::min(begin + BLOCK_SIZE, posting_offsets[t + 1]);
+            Block block;
+            block.last_doc_id = by_term[end - 1].doc_id;
+            block.position_count = 0;
+
+            values.clear();
+            for (uint32_t i = begin; i < end; i++) {
+                values.push_back(by_term[i].doc_id);
+            }
+            posting_codec::delta_encode(values.data(), values.size(), previous_doc_id);
+            block.postings_offset = data.size();
+            append(values);
+
+            values.clear();
+            for (uint32_t i = begin; i < end; i++) {
+                values.push_back(by_term[i].frequency);
+                block.position_count += by_term[i].frequency;
+            }
+            append(values);
+
+            values.clear();
+            for (uint32_t i = begin; i < end; i++) {
+                const uint32_t* source = positions.data() + by_term[i].positions_offset;
+                size_t at = values.size();
+                values.insert(values.end(), source, source + by_term[i].frequency);
+                posting_codec::delta_encode(values.data() + at, by_term[i].frequency, 0);
+            }
+            block.positions_offset = data.size();
+            append(values);
+
+            blocks.push_back(block);
+            previous_doc_id = block.last_doc_id;
+        }
+        block_offsets[t + 1] = static_cast<uint32_t>(blocks.size());
+    }
+    data.resize(data.size() + posting_codec::PADDING, 0);
+    data.shrink_to_fit();
+    blocks.shrink_to_fit();
+
+    std::vector<uint32_t>().swap(positions);
+    refresh_view();
+}
+
+PositionalIndex::Cursor PositionalIndex::postings_of(uint32_t term_id) const {
+    if (!finalized || term_id >= term_count()) {
+        return Cursor();
+    }
+    return Cursor(this, term_id);
+}
+
+size_t PositionalIndex::memory_usage() const {
+    return term_text.capacity() +
+           (term_offsets.capacity() + term_hashes.capacity() + slots.capacity() +
+            posting_offsets.capacity() + block_offsets.capacity() +
+            positions.capacity() + pending_terms.capacity()) * sizeof(uint32_t) +
+           blocks.capacity() * sizeof(Block) + data.capacity() +
+           postings.capacity() * sizeof(Posting);
+}
+
+namespace {
+
+PositionalIndex::FileHeader header_of(size_t term_count, size_t slot_count, posting_codec::Codec codec,
+                                      size_t term_text_size, size_t posting_count, size_t position_count,
+                                      size_t block_count, size_t data_size) {
+    PositionalIndex::FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.term_count = static_cast<uint32_t>(term_count);
+    header.slot_count = static_cast<uint32_t>(slot_count);
+    header.codec = static_cast<uint32_t>(codec);
+    header.term_text_size = term_text_size;
+    header.posting_count = posting_count;
+    header.position_count = position_count;
+    header.block_count = block_count;
+    header.data_size = data_size;
+    return header;
+}
+
+} // namespace
+
+size_t PositionalIndex::serialized_size() const {
+    return layout_of(header_of(view.term_count, view.slot_count, view.codec, view.term_text_size,
+                               view.posting_count, view.position_count, view.block_count, view.data_size)).end;
+}
+
+bool PositionalIndex::write(std::ostream& out) const {
+    if (!finalized) {
+        return false;
+    }
+    FileHeader header = header_of(view.term_count, view.slot_count, view.codec, view.term_text_size,
+                                  view.posting_count, view.position_count, view.block_count, view.data_size);
+    Layout layout = layout_of(header);
+
+    // Массивы пишутся по порядку, промежутки до границы 8 байт - нулями
+    size_t written = 0;
+    auto put = [&](size_t offset, const void* bytes_data, size_t bytes) {
+        static const char zeros[8] = {};
+        out.write(zeros, offset - written);
+        out.write(static_cast<const char*>(bytes_data), bytes);
+        written = offset + bytes;
+    };
+    size_t term_array = (size_t(view.term_count) + 1) * sizeof(uint32_t);
+    put(0, &header, sizeof(header));
+    put(layout.term_text, view.term_text, view.term_text_size);
+    put(layout.term_offsets, view.term_offsets, term_array);
+    put(layout.term_hashes, view.term_hashes, size_t(view.term_count) * sizeof(uint32_t));
+    put(layout.slots, view.slots, size_t(view.slot_count) * sizeof(uint32_t));
+    put(layout.posting_offsets, view.posting_offsets, term_array);
+    put(layout.block_offsets, view.block_offsets, term_array);
+    put(layout.blocks, view.blocks, view.block_count * sizeof(Block));
+    put(layout.data, view.data, view.data_size);
+    put(layout.end, nullptr, 0);
+    return static_cast<bool>(out);
+}
+
+bool PositionalIndex::attach(const char* bytes, size_t size) {
+    if (size < sizeof(FileHeader) || reinterpret_cast<uintptr_t>(bytes) % 8 != 0) {
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    // Размеры проверяются до подсчета смещений, чтобы сумма не переполнилась
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !posting_codec::is_valid(static_cast<posting_codec::Codec>(header.codec)) ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 ||
+        header.slot_count <= header.term_count ||
+        header.term_text_size > size || header.posting_count > size || header.position_count > size ||
+        header.block_count > size || header.data_size > size) {
+        return false;
+    }
+    Layout layout = layout_of(header);
+    if (layout.end > size) {
+        return false;
+    }
+
+    View mapped;
+    mapped.term_text = bytes + layout.term_text;
+    mapped.term_offsets = reinterpret_cast<const uint32_t*>(bytes + layout.term_offsets);
+    mapped.term_hashes = reinterpret_cast<const uint32_t*>(bytes + layout.term_hashes);
+    mapped.slots = reinterpret_cast<const uint32_t*>(bytes + layout.slots);
+    mapped.posting_offsets = reinterpret_cast<const uint32_t*>(bytes + layout.posting_offsets);
+    mapped.block_offsets = reinterpret_cast<const uint32_t*>(bytes + layout.block_offsets);
+    mapped.blocks = reinterpret_cast<const Block*>(bytes + layout.blocks);
+    mapped.data = reinterpret_cast<const uint8_t*>(bytes + layout.data);
+    mapped.term_count = header.term_count;
+    mapped.slot_count = header.slot_count;
+    mapped.term_text_size = header.term_text_size;
+    mapped.posting_count = header.posting_count;
+    mapped.position_count = header.position_count;
+    mapped.block_count = header.block_count;
+    mapped.data_size = header.data_size;
+    mapped.codec = static_cast<posting_codec::Codec>(header.codec);
+
+    // Смещения словаря, списков и заголовки блоков проверяются (это
+    // O(числа термов и блоков)); коды блоков не читаются, страницы
+    // подгружаются при поиске
+    if (mapped.term_offsets[0] != 0 || mapped.posting_offsets[0] != 0 || mapped.block_offsets[0] != 0 ||
+        mapped.term_offsets[header.term_count] != header.term_text_size ||
+        mapped.posting_offsets[header.term_count] != header.posting_count ||
+        mapped.block_offsets[header.term_count] != header.block_count) {
+        return false;
+    }
+    for (uint32_t t = 0; t < header.term_count; t++) {
+        if (mapped.term_offsets[t] > mapped.term_offsets[t + 1] ||
+            mapped.posting_offsets[t] > mapped.posting_offsets[t + 1]) {
+            return false;
+        }
+        // Блоков у терма - ровно столько, сколько нужно под его постинги
+        uint32_t list_size = mapped.posting_offsets[t + 1] - mapped.posting_offsets[t];
+        if (mapped.block_offsets[t] > mapped.block_offsets[t + 1] ||
+            mapped.block_offsets[t + 1] - mapped.block_offsets[t] != (list_size + BLOCK_SIZE - 1) / BLOCK_SIZE) {
+            return false;
+        }
+    }
+    uint64_t block_positions = 0;
+    for (size_t b = 0; b < header.block_count; b++) {
+        const Block& block = mapped.blocks[b];
+        if (block.postings_offset > block.positions_offset || block.positions_offset > header.data_size) {
+            return false;
+        }
+        block_positions += block.position_count;
+    }
+    if (block_positions != header.position_count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.slot_count; i++) {
+        if (mapped.slots[i] > header.term_count) {
+            return false;
+        }
+    }
+
+    // Векторы построения больше не нужны
+    std::string().swap(term_text);
+    std::vector<uint32_t>().swap(term_offsets);
+    std::vector<uint32_t>().swap(term_hashes);
+    std::vector<uint32_t>().swap(slots);
+    std::vector<uint32_t>().swap(posting_offsets);
+    std::vector<uint32_t>().swap(block_offsets);
+    std::vector<Block>().swap(blocks);
+    std::vector<uint8_t>().swap(data);
+    std::vector<Posting>().swap(postings);
+    std::vector<uint32_t>().swap(pending_terms);
+    std::vector<uint32_t>().swap(positions);
+    view = mapped;
+    finalized = true;
+    return true;
+}
+
+PositionalIndex::Cursor::Cursor()
+    : index(nullptr), block(0), block_end(0), first_block(0), list_size(0),
+      count(0), current(0), positions_ready(false) {}
+
+PositionalIndex::Cursor::Cursor(const PositionalIndex* index, uint32_t term_id)
+    : index(index), block(0), block_end(index->view.block_offsets[term_id + 1]),
+      first_block(index->view.block_offsets[term_id]),
+      list_size(index->view.posting_offsets[term_id + 1] - index->view.posting_offsets[term_id]),
+      count(0), current(0), positions_ready(false) {
+    load_block(first_block);
+}
+
+// Код у самого конца data копируется в буфер с нулями: декодер читает
+// с запасом, а у поврежденного файла код может быть длиннее, чем кажется
+const uint8_t* PositionalIndex::Cursor::code_at(uint64_t offset, size_t values) {
+    const View& view = index->view;
+    size_t needed = posting_codec::max_encoded_size(values) + posting_codec::PADDING;
+    if (view.data_size - offset >= needed) {
+        return view.data + offset;
+    }
+    tail.assign(view.data + offset, view.data + view.data_size);
+    tail.resize(needed, 0);
+    return tail.data();
+}
+
+void PositionalIndex::Cursor::load_block(uint32_t block_index) {
+    block = block_index;
+    current = 0;
+    count = 0;
+    positions_ready = false;
+    if (block >= block_end) {
+        return;
+    }
+
+    const View& view = index->view;
+    const Block& header = view.blocks[block];
+    uint32_t size = std::min(BLOCK_SIZE, list_size - (block - first_block) * BLOCK_SIZE);
+    // Код doc_id и код частот идут подряд
+    const uint8_t* code = code_at(header.postings_offset, 2 * size);
+    uint32_t previous_doc_id = block == first_block ? 0 : view.blocks[block - 1].last_doc_id;
+    code += posting_codec::decode_deltas(view.codec, code, size, previous_doc_id, doc_ids);
+    posting_codec::decode(view.codec, code, size, frequencies);
+
+    // Частоты должны сойтись с заголовком, иначе позиции не разрезать
+    // (только у поврежденного файла) - такой блок завершает список
+    position_starts[0] = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        if (frequencies[i] > header.position_count - position_starts[i]) {
+            block = block_end;
+            return;
+        }
+        position_starts[i + 1] = position_starts[i] + frequencies[i];
+    }
+    if (position_starts[size] != header.position_count) {
+        block = block_end;
+        return;
+    }
+    count = size;
+}
+
+void PositionalIndex::Cursor::advance_to(uint32_t target) {
+    if (!valid() || doc_ids[current] >= target) {
+        return;
+    }
+    const Block* blocks = index->view.blocks;
+    if (blocks[block].last_doc_id < target) {
+        // Галоп по блокам: шаги 1, 2, 4, ... до блока с last_doc_id >= target,
+        // затем двоичный поиск в последнем промежутке
+        uint32_t low = block + 1;
+        uint32_t step = 1;
+        uint32_t high = low;
+        while (high < block_end && blocks[high].last_doc_id < target) {
+            low = high + 1;
+            high = low + step;
+            step *= 2;
+        }
+        high = std::min(high, block_end);
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if (blocks[middle].last_doc_id < target) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        load_block(low);
+        if (!valid()) {
+            return;
+        }
+    }
+    // Внутри блока - тоже галопом от текущего постинга
+    uint32_t low = current;
+    uint32_t step = 1;
+    uint32_t high = low;
+    while (high < count && doc_ids[high] < target) {
+        low = high + 1;
+        high = low + step;
+        step *= 2;
+    }
+    high = std::min(high, count);
+    current = static_cast<uint32_t>(std::lower_bound(doc_ids + low, doc_ids + high, target) - doc_ids);
+    if (current == count) {
+        load_block(block + 1);
+    }
+}
+
+const uint32_t* PositionalIndex::Cursor::positions() {
+    if (!positions_ready) {
+        const Block& header = index->view.blocks[block];
+        block_positions.resize(size_t(header.position_count) + 1);
+        posting_codec::decode(index->view.codec, code_at(header.positions_offset, header.position_count),
+                              header.position_count, block_positions.data());
+        for (uint32_t i = 0; i < count; i++) {
+            posting_codec::delta_decode(block_positions.data() + position_starts[i], frequencies[i], 0);
+        }
+        positions_ready = true;
+    }
+    return block_positions.data() + position_starts[current];
+}
\ No newline at end of file
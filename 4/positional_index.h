@@ -0,0 +1,218 @@
+#ifndef POSITIONAL_INDEX_H
+#define POSITIONAL_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include "posting_codec.h"
+
+// Компактный позиционный индекс: вместо вложенных хеш-таблиц
+// (узел на терм, на пару терм-документ и вектор позиций на каждую)
+// все данные лежат в нескольких плоских массивах.
+//
+//   Словарь: терм -> id. Тексты термов подряд в одной строке, поиск -
+//   хеш-таблица с открытой адресацией по id (FNV-1a).
+//   Постинги терма t - posting_offsets[t + 1] - posting_offsets[t] штук
+//   по возрастанию doc_id, нарезаны на блоки по BLOCK_SIZE постингов
+//   (блоки терма - [block_offsets[t], block_offsets[t + 1])).
+//   Блок хранится сжатым (posting_codec): разности doc_id и частоты,
+//   отдельно - позиции всех его постингов, разностями внутри документа.
+//   Последний doc_id блока лежит в заголовке блока несжатым - по нему
+//   курсор перескакивает блоки, не распаковывая их.
+//
+// Постинги добавляются по возрастанию id документов (add_postings),
+// копятся в порядке документов, раскладываются по термам и сжимаются
+// один раз в finalize(). Искать можно только после finalize(). Индекс
+// не потокобезопасен: при параллельном построении у каждого потока свой
+// индекс (шард по хешу терма).
+//
+// Готовый индекс записывается в поток (write) и читается обратно без
+// разбора (attach): массивы файла, отображенного в память, используются
+// на месте. Формат (порядок байтов - как у машины, где он построен):
+//   FileHeader
+//   char term_text[term_text_size]
+//   uint32_t term_offsets[term_count + 1]
+//   uint32_t term_hashes[term_count]
+//   uint32_t slots[slot_count]
+//   uint32_t posting_offsets[term_count + 1]
+//   uint32_t block_offsets[term_count + 1]
+//   Block blocks[block_count]
+//   uint8_t data[data_size]   (коды блоков, в конце - PADDING нулей)
+// Каждый массив начинается с границы 8 байт.
+class PositionalIndex {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    static constexpr uint32_t BLOCK_SIZE = 128;
+
+    struct Block {
+        uint32_t last_doc_id;
+        uint32_t position_count;    // Позиций во всех постингах блока
+        uint64_t postings_offset;   // Код разностей doc_id, сразу за ним код частот (в data)
+        uint64_t positions_offset;  // Код разностей позиций (в data)
+    };
+
+    struct FileHeader {
+        char magic[4];  // "PIX2"
+        uint32_t term_count;
+        uint32_t slot_count;
+        uint32_t codec;  // posting_codec::Codec
+        uint64_t term_text_size;
+        uint64_t posting_count;
+        uint64_t position_count;
+        uint64_t block_count;
+        uint64_t data_size;
+    };
+
+    class Cursor;
+
+private:
+    struct Posting {
+        uint32_t doc_id;
+        uint32_t frequency;         // Число вхождений терма в документ
+        uint32_t positions_offset;  // Начало позиций в массиве positions
+    };
+
+    // Словарь
+    std::string term_text;
+    std::vector<uint32_t> term_offsets;  // [id] - начало терма в term_text, плюс конец последнего
+    std::vector<uint32_t> term_hashes;
+    std::vector<uint32_t> slots;         // id + 1, 0 - пустой слот; размер - степень двойки
+
+    // Сжатые постинги и позиции (после finalize)
+    std::vector<uint32_t> posting_offsets;
+    std::vector<uint32_t> block_offsets;
+    std::vector<Block> blocks;
+    std::vector<uint8_t> data;
+    posting_codec::Codec data_codec;
+    size_t total_positions;
+
+    // До finalize: постинги в порядке документов, term_id на каждый
+    // постинг и позиции подряд
+    std::vector<Posting> postings;
+    std::vector<uint32_t> pending_terms;
+    std::vector<uint32_t> positions;
+    bool finalized;
+
+    // Чтение идет через эти указатели: на векторы выше или, после
+    // attach, в отображенный файл. Обновляются после каждого изменения
+    struct View {
+        const char* term_text;
+        const uint32_t* term_offsets;
+        const uint32_t* term_hashes;
+        const uint32_t* slots;
+        const uint32_t* posting_offsets;
+        const uint32_t* block_offsets;
+        const Block* blocks;
+        const uint8_t* data;
+        uint32_t term_count;
+        uint32_t slot_count;
+        size_t term_text_size;
+        size_t posting_count;
+        size_t position_count;
+        size_t block_count;
+        size_t data_size;
+        posting_codec::Codec codec;
+    } view;
+
+    void refresh_view();
+    uint32_t find_slot(std::string_view term, uint32_t hash) const;
+    void grow_slots();
+
+public:
+    PositionalIndex();
+
+    // Копирование оставило бы view указывать на чужие массивы
+    PositionalIndex(const PositionalIndex&) = delete;
+    PositionalIndex& operator=(const PositionalIndex&) = delete;
+
+    // id терма, терм добавляется в словарь при первой встрече
+    uint32_t add_term(std::string_view term);
+    // id терма или NONE
+    uint32_t find_term(std::string_view term) const;
+    std::string_view term(uint32_t term_id) const;
+    size_t term_count() const { return view.term_count; }
+
+    // Постинг, уже собранный вызывающим: позиции терма в документе
+    // по возрастанию. doc_id не убывают от вызова к вызову
+    void add_postings(uint32_t term_id, uint32_t doc_id, const uint32_t* term_positions, size_t count);
+    // Раскладывает постинги по термам и сжимает их кодеком codec;
+    // после него add_postings не вызывать
+    void finalize(posting_codec::Codec codec = posting_codec::Codec::STREAM_VBYTE);
+
+    // Курсор по постингам терма (пустой для NONE и до finalize)
+    Cursor postings_of(uint32_t term_id) const;
+
+    size_t posting_count() const { return view.posting_count; }
+    size_t position_count() const { return view.position_count; }
+    posting_codec::Codec codec() const { return view.codec; }
+    // Размер сжатых постингов и позиций в байтах (с заголовками блоков)
+    size_t encoded_size() const { return view.data_size + view.block_count * sizeof(Block); }
+    // Память под данные индекса в байтах (по вместимости массивов;
+    // данные индекса из файла лежат в отображении и не учитываются)
+    size_t memory_usage() const;
+
+    // Запись готового (после finalize) индекса; false при ошибке записи
+    bool write(std::ostream& out) const;
+    // Размер записи write() в байтах
+    size_t serialized_size() const;
+    // Индекс поверх записанных write() данных, без копирования: data
+    // должна жить, пока используется индекс, и быть выровнена на 8 байт.
+    // false, если данные не похожи на индекс или обрезаны
+    bool attach(const char* data, size_t size);
+};
+
+// Проход по постингам одного терма с распаковкой блок за блоком:
+//
+//   for (auto cursor = index.postings_of(term_id); cursor.valid(); cursor.next()) {
+//       cursor.doc_id(); cursor.frequency(); cursor.positions();
+//   }
+//
+// Позиции блока распаковываются только при первом обращении к ним,
+// advance_to пропускает блоки по заголовкам. Курсор ссылается на
+// индекс и живет не дольше него
+class PositionalIndex::Cursor {
+    const PositionalIndex* index;
+    uint32_t block;       // Текущий блок
+    uint32_t block_end;   // Конец блоков терма
+    uint32_t first_block;
+    uint32_t list_size;   // Постингов у терма
+    uint32_t count;       // Постингов в текущем блоке, 0 - курсор в конце
+    uint32_t current;     // Номер постинга в блоке
+    bool positions_ready;
+    uint32_t doc_ids[BLOCK_SIZE];
+    uint32_t frequencies[BLOCK_SIZE];
+    uint32_t position_starts[BLOCK_SIZE + 1];
+    std::vector<uint32_t> block_positions;
+    std::vector<uint8_t> tail;  // Копия кода у конца data (см. decode)
+
+    void load_block(uint32_t block_index);
+    // Код values чисел с offset в data, который можно читать с запасом PADDING
+    const uint8_t* code_at(uint64_t offset, size_t values);
+
+public:
+    Cursor();
+    Cursor(const PositionalIndex* index, uint32_t term_id);
+
+    bool valid() const { return current < count; }
+    uint32_t doc_id() const { return doc_ids[current]; }
+    uint32_t frequency() const { return frequencies[current]; }
+    // Постингов у терма (документная частота)
+    size_t size() const { return list_size; }
+
+    void next() {
+        if (++current == count) {
+            load_block(block + 1);
+        }
+    }
+    // Переход к первому постингу с doc_id >= target (вперед, не назад):
+    // галопом по последним doc_id блоков, затем внутри блока
+    void advance_to(uint32_t target);
+    // Позиции терма в текущем документе: frequency() штук по возрастанию
+    const uint32_t* positions();
+};
+
+#endif
\ No newline at end of file
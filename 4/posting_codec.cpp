@@ -0,0 +1,238 @@
+#include "posting_codec.h"
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <tmmintrin.h>
+#define POSTING_CODEC_SSSE3 1
+#define POSTING_CODEC_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POSTING_CODEC_SSE2 1
+#endif
+
+namespace posting_codec {
+
+namespace {
+
+// ---- VByte ----
+
+size_t vbyte_encode(const uint32_t* values, size_t count, uint8_t* out) {
+    uint8_t* at = out;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = values[i];
+        while (value >= 0x80) {
+            *at++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *at++ = static_cast<uint8_t>(value);
+    }
+    return at - out;
+}
+
+size_t vbyte_decode(const uint8_t* in, size_t count, uint32_t* out) {
+    const uint8_t* at = in;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t byte = *at++;
+        // Большинство разностей укладывается в один байт
+        if (byte < 0x80) {
+            out[i] = byte;
+            continue;
+        }
+        uint32_t value = byte & 0x7F;
+        for (int shift = 7;; shift += 7) {
+            byte = *at++;
+            value |= (byte & 0x7F) << shift;
+            if (byte < 0x80 || shift >= 28) {
+                break;
+            }
+        }
+        out[i] = value;
+    }
+    return at - in;
+}
+
+// ---- Stream VByte ----
+//
+// Код count чисел: ceil(count / 4) управляющих байтов, затем данные.
+// В управляющем байте по 2 бита на число (младшие - первое число
+// четверки): длина числа в байтах минус один. Данные - младшие байты
+// чисел (little-endian), подряд без выравнивания.
+
+struct StreamTables {
+    uint8_t length[256];       // Суммарная длина данных четверки
+#ifdef POSTING_CODEC_SSSE3
+    uint8_t shuffle[256][16];  // Маска pshufb: байты данных -> 4 числа по 4 байта
+#endif
+
+    StreamTables() {
+        for (int control = 0; control < 256; control++) {
+            size_t offset = 0;
+            for (int lane = 0; lane < 4; lane++) {
+                size_t bytes = ((control >> (2 * lane)) & 3) + 1;
+#ifdef POSTING_CODEC_SSSE3
+                for (size_t b = 0; b < 4; b++) {
+                    // 0x80 в маске pshufb обнуляет байт
+                    shuffle[control][lane * 4 + b] = b < bytes ? static_cast<uint8_t>(offset + b) : 0x80;
+                }
+#endif
+                offset += bytes;
+            }
+            length[control] = static_cast<uint8_t>(offset);
+        }
+    }
+};
+
+const StreamTables stream_tables;
+
+inline uint32_t byte_length(uint32_t value) {
+    return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+}
+
+size_t stream_encode(const uint32_t* values, size_t count, uint8_t* out) {
+    uint8_t* control = out;
+    uint8_t* data = out + (count + 3) / 4;
+    std::memset(control, 0, (count + 3) / 4);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = values[i];
+        uint32_t bytes = byte_length(value);
+        control[i / 4] |= static_cast<uint8_t>((bytes - 1) << (2 * (i % 4)));
+        for (uint32_t b = 0; b < bytes; b++) {
+            *data++ = static_cast<uint8_t>(value >> (8 * b));
+        }
+    }
+    return data - out;
+}
+
+// Одно число: 4 байта читаются разом и лишние отрезаются маской
+// (отсюда требование PADDING за концом кода)
+inline uint32_t load_value(const uint8_t* data, uint32_t code) {
+    static const uint32_t MASKS[4] = {0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu};
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value & MASKS[code];
+}
+
+size_t stream_decode(const uint8_t* in, size_t count, uint32_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + (count + 3) / 4;
+    size_t full_groups = count / 4;
+
+    for (size_t g = 0; g < full_groups; g++) {
+        uint8_t code = control[g];
+#ifdef POSTING_CODEC_SSSE3
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream_tables.shuffle[code]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), _mm_shuffle_epi8(bytes, mask));
+        data += stream_tables.length[code];
+#else
+        const uint8_t* at = data;
+        for (int lane = 0; lane < 4; lane++) {
+            uint32_t lane_code = (code >> (2 * lane)) & 3;
+            out[4 * g + lane] = load_value(at, lane_code);
+            at += lane_code + 1;
+        }
+        data = at;
+#endif
+    }
+
+    // Неполная последняя четверка
+    for (size_t i = full_groups * 4; i < count; i++) {
+        uint32_t code = (control[i / 4] >> (2 * (i % 4))) & 3;
+        out[i] = load_value(data, code);
+        data += code + 1;
+    }
+    return data - in;
+}
+
+#ifdef POSTING_CODEC_SSE2
+// Префиксные суммы четверки плюс previous (в нем во всех дорожках
+// последнее значение предыдущей четверки)
+inline __m128i prefix_sum(__m128i values, __m128i previous) {
+    values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+    values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+    return _mm_add_epi32(values, previous);
+}
+#endif
+
+#ifdef POSTING_CODEC_SSSE3
+size_t stream_decode_deltas(const uint8_t* in, size_t count, uint32_t base, uint32_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + (count + 3) / 4;
+    size_t full_groups = count / 4;
+
+    __m128i previous = _mm_set1_epi32(static_cast<int>(base));
+    for (size_t g = 0; g < full_groups; g++) {
+        uint8_t code = control[g];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream_tables.shuffle[code]));
+        __m128i values = prefix_sum(_mm_shuffle_epi8(bytes, mask), previous);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), values);
+        previous = _mm_shuffle_epi32(values, _MM_SHUFFLE(3, 3, 3, 3));
+        data += stream_tables.length[code];
+    }
+    base = static_cast<uint32_t>(_mm_cvtsi128_si32(previous));
+
+    for (size_t i = full_groups * 4; i < count; i++) {
+        uint32_t code = (control[i / 4] >> (2 * (i % 4))) & 3;
+        base += load_value(data, code);
+        out[i] = base;
+        data += code + 1;
+    }
+    return data - in;
+}
+#endif
+
+} // namespace
+
+const char* name(Codec codec) {
+    switch (codec) {
+    case Codec::VBYTE:
+        return "vbyte";
+    case Codec::STREAM_VBYTE:
+        return "stream-vbyte";
+    }
+    return "unknown";
+}
+
+bool is_valid(Codec codec) {
+    return codec == Codec::VBYTE || codec == Codec::STREAM_VBYTE;
+}
+
+size_t encode(Codec codec, const uint32_t* values, size_t count, uint8_t* out) {
+    return codec == Codec::VBYTE ? vbyte_encode(values, count, out) : stream_encode(values, count, out);
+}
+
+size_t decode(Codec codec, const uint8_t* in, size_t count, uint32_t* out) {
+    return codec == Codec::VBYTE ? vbyte_decode(in, count, out) : stream_decode(in, count, out);
+}
+
+size_t decode_deltas(Codec codec, const uint8_t* in, size_t count, uint32_t base, uint32_t* out) {
+#ifdef POSTING_CODEC_SSSE3
+    if (codec == Codec::STREAM_VBYTE) {
+        return stream_decode_deltas(in, count, base, out);
+    }
+#endif
+    size_t bytes = decode(codec, in, count, out);
+    delta_decode(out, count, base);
+    return bytes;
+}
+
+void delta_decode(uint32_t* values, size_t count, uint32_t base) {
+    size_t i = 0;
+#ifdef POSTING_CODEC_SSE2
+    __m128i previous = _mm_set1_epi32(static_cast<int>(base));
+    for (; i + 4 <= count; i += 4) {
+        __m128i* at = reinterpret_cast<__m128i*>(values + i);
+        __m128i sums = prefix_sum(_mm_loadu_si128(at), previous);
+        _mm_storeu_si128(at, sums);
+        previous = _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    base = static_cast<uint32_t>(_mm_cvtsi128_si32(previous));
+#endif
+    for (; i < count; i++) {
+        base += values[i];
+        values[i] = base;
+    }
+}
+
+} // namespace posting_codec
\ No newline at end of file
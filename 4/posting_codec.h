@@ -0,0 +1,63 @@
+#ifndef POSTING_CODEC_H
+#define POSTING_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Сжатие возрастающих последовательностей (id документов, позиции):
+// сначала разности соседних значений (d-gaps), потом код переменной
+// длины - маленькие разности занимают один байт вместо четырех.
+//
+//   VBYTE        - классический varint: 7 бит на байт, старший бит -
+//                  "дальше есть еще байт". Простой, но декодер ветвится
+//                  на каждом байте.
+//   STREAM_VBYTE - управляющие байты отдельно от данных: один байт
+//                  описывает длины (1..4 байта) четырех чисел, данные
+//                  лежат подряд. Четверка распаковывается одной
+//                  перестановкой байтов (pshufb) по таблице, без ветвлений.
+//
+// Декодер читает до PADDING байт за концом кода: буфер с кодом должен
+// быть дополнен (хотя бы нулями) на столько байт.
+namespace posting_codec {
+
+enum class Codec : uint32_t {
+    VBYTE = 1,
+    STREAM_VBYTE = 2
+};
+
+constexpr size_t PADDING = 16;
+
+const char* name(Codec codec);
+// false, если такого кодека нет (например, из поврежденного файла)
+bool is_valid(Codec codec);
+
+// Наибольший размер кода count чисел любым кодеком
+inline size_t max_encoded_size(size_t count) {
+    return count * 5;
+}
+
+// Кодирует count чисел в out (не меньше max_encoded_size байт),
+// возвращает размер кода
+size_t encode(Codec codec, const uint32_t* values, size_t count, uint8_t* out);
+// Декодирует count чисел, возвращает число прочитанных байт
+size_t decode(Codec codec, const uint8_t* in, size_t count, uint32_t* out);
+// То же с delta_decode(out, count, base): Stream VByte с SSSE3
+// считает префиксные суммы, пока четверка еще в регистре
+size_t decode_deltas(Codec codec, const uint8_t* in, size_t count, uint32_t base, uint32_t* out);
+
+// Разности соседних значений на месте; первое - разность с base
+inline void delta_encode(uint32_t* values, size_t count, uint32_t base) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = values[i];
+        values[i] = value - base;
+        base = value;
+    }
+}
+
+// Обратное к delta_encode: префиксные суммы на месте (с SSE2 -
+// по четыре числа за шаг)
+void delta_decode(uint32_t* values, size_t count, uint32_t base);
+
+} // namespace posting_codec
+
+#endif
\ No newline at end of file
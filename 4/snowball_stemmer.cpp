@@ -0,0 +1,186 @@
+#include "snowball_stemmer.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+const std::string_view E = "е";
+const std::string_view YO = "ё";
+
+// Гласные в UTF-8 - два байта: D0 xx (а е и о) или D1 xx (у ы э ю я ё).
+// Маски по младшим 6 битам второго байта
+constexpr uint64_t bit(unsigned byte) {
+    return uint64_t(1) << (byte & 0x3F);
+}
+constexpr uint64_t VOWELS_D0 = bit(0xB0) | bit(0xB5) | bit(0xB8) | bit(0xBE);
+constexpr uint64_t VOWELS_D1 = bit(0x83) | bit(0x8B) | bit(0x8D) | bit(0x8E) | bit(0x8F) | bit(0x91);
+
+bool is_vowel(unsigned char lead, unsigned char second) {
+    uint64_t mask = lead == 0xD0 ? VOWELS_D0 : lead == 0xD1 ? VOWELS_D1 : 0;
+    return (mask >> (second & 0x3F)) & 1;
+}
+
+bool ends_with(std::string_view word, std::string_view ending) {
+    return word.size() >= ending.size() &&
+           word.compare(word.size() - ending.size(), ending.size(), ending) == 0;
+}
+
+} // namespace
+
+SnowballStemmer::SnowballStemmer() {
+    add(perfective_gerund, {"в", "вши", "вшись"}, AFTER_A);
+    add(perfective_gerund, {"ив", "ивши", "ившись", "ыв", "ывши", "ывшись"}, ANY);
+
+    add(reflexive, {"ся", "сь"}, ANY);
+
+    add(adjective, {
+        "ее", "ие", "ые", "ое", "ими", "ыми", "ей", "ий", "ый", "ой",
+        "ем", "им", "ым", "ом", "его", "ого", "ему", "ому", "их", "ых",
+        "ую", "юю", "ая", "яя", "ою", "ею"
+    }, ANY);
+
+    add(participle, {"ем", "нн", "вш", "ющ", "щ"}, AFTER_A);
+    add(participle, {"ивш", "ывш", "ующ"}, ANY);
+
+    add(verb, {
+        "ла", "на", "ете", "йте", "ли", "й", "л", "ем", "н", "ло",
+        "но", "ет", "ют", "ны", "ть", "ешь", "нно"
+    }, AFTER_A);
+    add(verb, {
+        "ила", "ыла", "ена", "ейте", "уйте", "ите", "или", "ыли", "ей",
+        "уй", "ил", "ыл", "им", "ым", "ен", "ило", "ыло", "ено", "ят",
+        "ует", "уют", "ит", "ыт", "ены", "ить", "ыть", "ишь", "ую", "ю"
+    }, ANY);
+
+    add(noun, {
+        "а", "ев", "ов", "ие", "ье", "е", "иями", "ями", "ами", "еи",
+        "ии", "и", "ией", "ей", "ой", "ий", "й", "иям", "ям", "ием",
+        "ем", "ам", "ом", "о", "у", "ах", "иях", "ях", "ы", "ь",
+        "ию", "ью", "ю", "ия", "ья", "я"
+    }, ANY);
+
+    add(derivational, {"ост", "ость"}, ANY);
+
+    add(tidy_up, {"ейш", "ейше"}, SUPERLATIVE);
+    add(tidy_up, {"н"}, DOUBLE_N);
+    add(tidy_up, {"ь"}, SOFT_SIGN);
+}
+
+void SnowballStemmer::add(SuffixTrie& trie, std::initializer_list<std::string_view> endings, uint32_t id) {
+    for (std::string_view ending : endings) {
+        // Позиции "е" - каждую можно заменить на "ё" (2^k вариантов)
+        std::vector<size_t> positions;
+        for (size_t pos = ending.find(E); pos != std::string_view::npos; pos = ending.find(E, pos + E.size())) {
+            positions.push_back(pos);
+        }
+        for (size_t mask = 0; mask < (size_t(1) << positions.size()); mask++) {
+            std::string variant(ending);
+            for (size_t i = 0; i < positions.size(); i++) {
+                if (mask & (size_t(1) << i)) {
+                    variant.replace(positions[i], E.size(), YO);
+                }
+            }
+            trie.insert(variant, id);
+        }
+    }
+}
+
+void SnowballStemmer::mark_regions(std::string_view word, size_t& rv, size_t& r2) {
+    // RV - после первой гласной; R1 - после первой согласной, следующей
+    // за гласной; R2 - то же внутри R1. Если области нет - она пуста
+    rv = r2 = word.size();
+    size_t pos = 0;
+    // Сколько переходов "гласная -> согласная" осталось до R2
+    int transitions = 2;
+    bool after_vowel = false;
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(word.data());
+    while (pos < word.size()) {
+        size_t start = pos++;
+        while (pos < word.size() && (s[pos] & 0xC0) == 0x80) {
+            pos++;
+        }
+        bool vowel = pos - start == 2 && is_vowel(s[start], s[start + 1]);
+        if (vowel && rv == word.size()) {
+            rv = pos;
+        }
+        if (vowel) {
+            after_vowel = true;
+        } else if (after_vowel) {
+            after_vowel = false;
+            if (--transitions == 0) {
+                r2 = pos;
+                return;
+            }
+        }
+    }
+}
+
+bool SnowballStemmer::remove(const SuffixTrie& trie, std::string_view word, size_t rv, size_t& end) {
+    std::string_view region = word.substr(rv, end - rv);
+    uint32_t id;
+    size_t length = trie.longest_match(region, id);
+    if (length == 0) {
+        return false;
+    }
+    // Окончания первой группы отсекаются, только если перед ними
+    // (тоже внутри RV) стоит "а" или "я"
+    std::string_view before = region.substr(0, region.size() - length);
+    if (id == AFTER_A && !ends_with(before, "а") && !ends_with(before, "я")) {
+        return false;
+    }
+    end -= length;
+    return true;
+}
+
+size_t SnowballStemmer::stem_length(std::string_view word) const {
+    size_t rv, r2;
+    mark_regions(word, rv, r2);
+    size_t end = word.size();
+    if (rv >= end) {
+        return end;
+    }
+
+    // Шаг 1: деепричастие; иначе возвратная частица и затем
+    // прилагательное (с причастием), глагол или существительное
+    if (!remove(perfective_gerund, word, rv, end)) {
+        remove(reflexive, word, rv, end);
+        if (remove(adjective, word, rv, end)) {
+            remove(participle, word, rv, end);
+        } else if (!remove(verb, word, rv, end)) {
+            remove(noun, word, rv, end);
+        }
+    }
+
+    // Шаг 2: конечное "и"
+    if (end > rv && ends_with(word.substr(rv, end - rv), "и")) {
+        end -= std::string_view("и").size();
+    }
+
+    // Шаг 3: словообразовательный суффикс, только целиком в R2
+    uint32_t id;
+    size_t length = derivational.longest_match(word.substr(rv, end - rv), id);
+    if (length > 0 && end - length >= r2) {
+        end -= length;
+    }
+
+    // Шаг 4: превосходная степень, "нн" -> "н", мягкий знак
+    length = tidy_up.longest_match(word.substr(rv, end - rv), id);
+    if (length > 0) {
+        std::string_view n = "н";
+        if (id == SUPERLATIVE) {
+            end -= length;
+            if (ends_with(word.substr(rv, end - rv), "нн")) {
+                end -= n.size();
+            }
+        } else if (id == DOUBLE_N) {
+            if (ends_with(word.substr(rv, end - rv), "нн")) {
+                end -= n.size();
+            }
+        } else {
+            end -= length;
+        }
+    }
+
+    return end;
+}
\ No newline at end of file
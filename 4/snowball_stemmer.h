@@ -0,0 +1,56 @@
+#ifndef SNOWBALL_STEMMER_H
+#define SNOWBALL_STEMMER_H
+
+#include <string_view>
+#include <initializer_list>
+#include "suffix_trie.h"
+
+// Стеммер Snowball для русского языка (snowballstem.org/algorithms/russian).
+// Работает прямо с UTF-8: каждая группа окончаний - бор по байтам
+// перевернутых окончаний, т.е. конечный автомат, который читает слово
+// с конца. Все шаги только отсекают окончания, поэтому основа - начало
+// слова и результат - ее длина в байтах.
+//
+// Отличие от эталона: вместо замены ё на е (в эталоне это делается
+// перед стеммингом) окончания с е добавлены в бор и в вариантах с ё,
+// чтобы основа оставалась началом исходного слова.
+class SnowballStemmer {
+private:
+    // id окончания в боре: удаляется всегда или только после "а"/"я"
+    enum Group : uint32_t {
+        AFTER_A = 0,
+        ANY = 1
+    };
+    // id для последнего шага
+    enum TidyUp : uint32_t {
+        SUPERLATIVE = 0,  // ейш, ейше
+        DOUBLE_N = 1,     // н (нн -> н)
+        SOFT_SIGN = 2     // ь
+    };
+
+    SuffixTrie perfective_gerund;
+    SuffixTrie reflexive;
+    SuffixTrie adjective;
+    SuffixTrie participle;
+    SuffixTrie verb;
+    SuffixTrie noun;
+    SuffixTrie derivational;
+    SuffixTrie tidy_up;
+
+    static void add(SuffixTrie& trie, std::initializer_list<std::string_view> endings, uint32_t id);
+
+    // Начала областей RV и R2 (байтовые позиции)
+    static void mark_regions(std::string_view word, size_t& rv, size_t& r2);
+
+    // Отсекает самое длинное окончание из trie, лежащее в RV;
+    // end - текущая длина слова. false, если отсекать нечего
+    static bool remove(const SuffixTrie& trie, std::string_view word, size_t rv, size_t& end);
+
+public:
+    SnowballStemmer();
+
+    // Длина основы слова (UTF-8, нижний регистр) в байтах
+    size_t stem_length(std::string_view word) const;
+};
+
+#endif
\ No newline at end of file
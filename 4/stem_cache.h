@@ -0,0 +1,188 @@
+#ifndef STEM_CACHE_H
+#define STEM_CACHE_H
+
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "fnv1a.h"
+
+// Ограниченный потокобезопасный кэш "слово -> длина основы".
+// Частоты слов подчиняются закону Ципфа, поэтому небольшой кэш
+// покрывает большую часть вызовов стеммера. Кэш разбит на сегменты
+// (шарды) по хешу слова, у каждого свой мьютекс - общей блокировки
+// между потоками нет. Вытеснение - алгоритм CLOCK (приближение LRU):
+// при попадании у записи ставится бит обращения, "стрелка" пропускает
+// записи с битом (сбрасывая его) и вытесняет первую без него.
+//
+// Запись занимает ровно одну строку кэша процессора (64 байта), слово
+// хранится в ней же - попадание не ходит по указателям в кучу.
+// Слова (UTF-8) длиннее KEY_CAPACITY байт не кэшируются (они редки).
+class StemCache {
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+    };
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct alignas(64) Entry {
+        uint32_t hash;
+        uint32_t next;        // Следующая запись в цепочке корзины
+        uint8_t key_length;
+        uint8_t stem_length;
+        bool referenced;      // Бит обращения для CLOCK
+        char key[64 - 11];
+    };
+
+public:
+    static constexpr size_t KEY_CAPACITY = sizeof(Entry::key);
+
+private:
+    // Выравнивание по строке кэша: мьютексы соседних шардов
+    // не делят одну строку между ядрами
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;     // Не больше shard_capacity
+        std::vector<uint32_t> buckets;  // Начала цепочек, размер - степень двойки
+        size_t hand = 0;                // Стрелка CLOCK
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    size_t shard_capacity;
+    mutable Shard shards[SHARD_COUNT];
+
+    Shard& shard_of(uint32_t hash) const {
+        return shards[hash % SHARD_COUNT];
+    }
+
+    static uint32_t& bucket_of(Shard& shard, uint32_t hash) {
+        return shard.buckets[(hash / SHARD_COUNT) & (shard.buckets.size() - 1)];
+    }
+
+    static uint32_t find_entry(Shard& shard, uint32_t hash, std::string_view word) {
+        for (uint32_t i = bucket_of(shard, hash); i != NONE; i = shard.entries[i].next) {
+            const Entry& entry = shard.entries[i];
+            if (entry.hash == hash && entry.key_length == word.size() &&
+                std::equal(word.begin(), word.end(), entry.key)) {
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+    static void unlink(Shard& shard, uint32_t index) {
+        uint32_t* link = &bucket_of(shard, shard.entries[index].hash);
+        while (*link != index) {
+            link = &shard.entries[*link].next;
+        }
+        *link = shard.entries[index].next;
+    }
+
+    // Запись для вытеснения: первая без бита обращения
+    static uint32_t clock_victim(Shard& shard) {
+        while (shard.entries[shard.hand].referenced) {
+            shard.entries[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+        }
+        uint32_t victim = static_cast<uint32_t>(shard.hand);
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+        return victim;
+    }
+
+public:
+    // capacity - общее число слов во всех шардах
+    explicit StemCache(size_t capacity) {
+        shard_capacity = std::max<size_t>(capacity / SHARD_COUNT, 1);
+        size_t bucket_count = 1;
+        while (bucket_count < shard_capacity) {
+            bucket_count *= 2;
+        }
+        for (Shard& shard : shards) {
+            shard.entries.reserve(shard_capacity);
+            shard.buckets.assign(bucket_count, NONE);
+        }
+    }
+
+    StemCache(const StemCache&) = delete;
+    StemCache& operator=(const StemCache&) = delete;
+
+    static bool cacheable(std::string_view word) {
+        return word.size() <= KEY_CAPACITY;
+    }
+
+    // true и длина основы в length, если слово есть в кэше
+    bool find(std::string_view word, size_t& length) const {
+        uint32_t hash = fnv1a(word);
+        Shard& shard = shard_of(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        uint32_t index = find_entry(shard, hash, word);
+        if (index == NONE) {
+            shard.misses++;
+            return false;
+        }
+        Entry& entry = shard.entries[index];
+        entry.referenced = true;
+        length = entry.stem_length;
+        shard.hits++;
+        return true;
+    }
+
+    // Слово должно быть cacheable
+    void insert(std::string_view word, size_t length) {
+        uint32_t hash = fnv1a(word);
+        Shard& shard = shard_of(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // Слово мог уже добавить другой поток
+        if (find_entry(shard, hash, word) != NONE) {
+            return;
+        }
+
+        uint32_t index;
+        if (shard.entries.size() < shard_capacity) {
+            index = static_cast<uint32_t>(shard.entries.size());
+            shard.entries.emplace_back();
+        } else {
+            index = clock_victim(shard);
+            unlink(shard, index);
+            shard.evictions++;
+        }
+
+        Entry& entry = shard.entries[index];
+        entry.hash = hash;
+        entry.key_length = static_cast<uint8_t>(word.size());
+        entry.stem_length = static_cast<uint8_t>(length);
+        entry.referenced = false;
+        std::copy(word.begin(), word.end(), entry.key);
+        uint32_t& head = bucket_of(shard, hash);
+        entry.next = head;
+        head = index;
+    }
+
+    // Сумма счетчиков по всем шардам
+    Stats stats() const {
+        Stats total;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.evictions += shard.evictions;
+            total.size += shard.entries.size();
+        }
+        return total;
+    }
+};
+
+#endif
\ No newline at end of file
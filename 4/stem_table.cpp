@@ -0,0 +1,116 @@
+#include "stem_table.h"
+#include "fnv1a.h"
+#include <fstream>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'S', 'T', 'B', '1'};
+
+} // namespace
+
+StemTable::StemTable()
+    : slots(nullptr), slot_count(0), words(nullptr), words_size(0),
+      algorithm_id(0), word_count(0) {}
+
+bool StemTable::open(const std::string& path) {
+    slots = nullptr;
+    if (!file.open(path, MappedFile::Access::Random)) {
+        return false;
+    }
+    std::string_view data = file.view();
+    if (data.size() < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data.data(), sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 ||
+        data.size() < sizeof(Header) + size_t(header.slot_count) * sizeof(Slot)) {
+        return false;
+    }
+
+    // Отображение выровнено по странице, слоты идут сразу за заголовком
+    slots = reinterpret_cast<const Slot*>(data.data() + sizeof(Header));
+    slot_count = header.slot_count;
+    words = data.data() + sizeof(Header) + size_t(slot_count) * sizeof(Slot);
+    words_size = data.size() - sizeof(Header) - size_t(slot_count) * sizeof(Slot);
+    algorithm_id = header.algorithm;
+    word_count = header.word_count;
+    return true;
+}
+
+bool StemTable::find(std::string_view word, size_t& length) const {
+    if (slots == nullptr || word.empty() || word.size() > MAX_WORD_LENGTH) {
+        return false;
+    }
+    uint32_t hash = fnv1a(word);
+    uint32_t mask = slot_count - 1;
+    // Не больше slot_count проб - даже если файл испорчен и пустых слотов нет
+    for (uint32_t probe = 0, i = hash & mask; probe < slot_count; probe++, i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.word_length == 0) {
+            return false;
+        }
+        if (slot.hash == hash && slot.word_length == word.size() &&
+            size_t(slot.offset) + slot.word_length <= words_size &&
+            std::memcmp(words + slot.offset, word.data(), word.size()) == 0) {
+            length = slot.stem_length <= slot.word_length ? slot.stem_length : slot.word_length;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StemTable::write(const std::string& path, uint32_t algorithm,
+                      const std::vector<std::pair<std::string, size_t>>& entries) {
+    // Заполнение не больше половины: пробы короткие
+    uint32_t slot_count = 1;
+    while (slot_count < entries.size() * 2) {
+        slot_count *= 2;
+    }
+
+    std::vector<Slot> table(slot_count, Slot{0, 0, 0, 0, 0});
+    std::string text;
+    uint32_t word_count = 0;
+    uint32_t mask = slot_count - 1;
+
+    for (const auto& [word, stem_length] : entries) {
+        if (word.empty() || word.size() > MAX_WORD_LENGTH) {
+            continue;
+        }
+        uint32_t hash = fnv1a(word);
+        uint32_t i = hash & mask;
+        bool duplicate = false;
+        while (table[i].word_length != 0) {
+            if (table[i].hash == hash && table[i].word_length == word.size() &&
+                text.compare(table[i].offset, word.size(), word) == 0) {
+                duplicate = true;
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        if (duplicate) {
+            continue;
+        }
+        table[i].hash = hash;
+        table[i].offset = static_cast<uint32_t>(text.size());
+        table[i].word_length = static_cast<uint8_t>(word.size());
+        table[i].stem_length = static_cast<uint8_t>(stem_length < word.size() ? stem_length : word.size());
+        text += word;
+        word_count++;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.algorithm = algorithm;
+    header.word_count = word_count;
+    header.slot_count = slot_count;
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(Slot));
+    out.write(text.data(), text.size());
+    return static_cast<bool>(out);
+}
\ No newline at end of file
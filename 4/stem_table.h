@@ -0,0 +1,69 @@
+#ifndef STEM_TABLE_H
+#define STEM_TABLE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "mapped_file.h"
+
+// Заранее посчитанная таблица "слово -> длина основы" (строится утилитой
+// build_stem_table по словарю корпуса). Файл отображается в память
+// и при открытии не разбирается - старт мгновенный, страницы подгружаются
+// по мере обращений. Поиск - хеш-таблица с открытой адресацией
+// (заполнена не больше чем наполовину): хеш и обычно одна проба.
+//
+// Формат файла (порядок байтов - как у машины, где он построен):
+//   Header
+//   Slot[slot_count]    - slot_count - степень двойки, пустой слот: word_length == 0
+//   char words[]        - слова подряд, Slot::offset - смещение от начала words
+class StemTable {
+public:
+    struct Header {
+        char magic[4];        // "STB1"
+        uint32_t algorithm;   // Алгоритм стемминга, которым посчитана таблица
+        uint32_t word_count;
+        uint32_t slot_count;
+    };
+
+    struct Slot {
+        uint32_t hash;
+        uint32_t offset;
+        uint8_t word_length;  // В байтах; 0 - слот пуст
+        uint8_t stem_length;
+        uint16_t reserved;
+    };
+
+    // Слова длиннее (в байтах) в таблицу не попадают
+    static constexpr size_t MAX_WORD_LENGTH = 255;
+
+private:
+    MappedFile file;
+    const Slot* slots;
+    uint32_t slot_count;
+    const char* words;
+    size_t words_size;
+    uint32_t algorithm_id;
+    uint32_t word_count;
+
+public:
+    StemTable();
+
+    // false, если файл не открылся или не похож на таблицу основ
+    bool open(const std::string& path);
+
+    uint32_t algorithm() const { return algorithm_id; }
+    size_t size() const { return word_count; }
+
+    // true и длина основы в байтах в length, если слово есть в таблице
+    bool find(std::string_view word, size_t& length) const;
+
+    // Записывает таблицу из пар (слово, длина основы); слова длиннее
+    // MAX_WORD_LENGTH пропускаются. false при ошибке записи
+    static bool write(const std::string& path, uint32_t algorithm,
+                      const std::vector<std::pair<std::string, size_t>>& entries);
+};
+
+#endif
\ No newline at end of file
@@ -1,162 +1,218 @@
 #include "stemmer.h"
+#include "utf8.h"
 #include <iostream>
 #include <algorithm>
-#include <codecvt>
-#include <locale>
-#include <cwctype>  // Добавляем для функций wide char
 
-RussianStemmer::RussianStemmer() {
+RussianStemmer::RussianStemmer(Algorithm algorithm) : algorithm(algorithm) {
     // Инициализация исключений
-    std::vector<std::wstring> exception_list = {
-        L"это", L"что", L"как", L"так", L"здесь", L"там", L"где",
-        L"кто", L"чем", L"сам", L"сама", L"само", L"сами"
+    std::vector<std::string> exception_list = {
+        "это", "что", "как", "так", "здесь", "там", "где",
+        "кто", "чем", "сам", "сама", "само", "сами"
     };
     
-    for (const auto& word : exception_list) {
-        exceptions.insert(word);
-    }
+    exceptions = exception_list;
+    std::sort(exceptions.begin(), exceptions.end());
     
     // Инициализация окончаний (по приоритету - от самых длинных к коротким)
-    endings = {
-        L"иями", L"иях", L"иям", L"иев", L"ием", L"ию", L"ие", L"ий", 
-        L"ия", L"ии", L"ями", L"ях", L"ям", L"ев", L"ем", L"ю", L"е", 
-        L"й", L"я", L"и", L"а", L"о", L"у", L"ы", L"ь"
+    std::vector<std::string> ending_list = {
+        "иями", "иях", "иям", "иев", "ием", "ию", "ие", "ий", 
+        "ия", "ии", "ями", "ях", "ям", "ев", "ем", "ю", "е", 
+        "й", "я", "и", "а", "о", "у", "ы", "ь"
     };
+    for (size_t i = 0; i < ending_list.size(); i++) {
+        endings.insert(ending_list[i], static_cast<uint32_t>(i));
+    }
+    
+    // Дополнительные суффиксы, отсекаемые после окончания (тоже по приоритету)
+    std::vector<std::string> suffix_list = {"ость", "тель", "ник", "ок"};
+    for (size_t i = 0; i < suffix_list.size(); i++) {
+        suffixes.insert(suffix_list[i], static_cast<uint32_t>(i));
+    }
 }
 
-bool RussianStemmer::is_vowel(wchar_t c) const {
-    // Используем towlower из cwctype (глобальное пространство имен)
-    c = towlower(c);
-    return c == L'а' || c == L'е' || c == L'ё' || c == L'и' || 
-           c == L'о' || c == L'у' || c == L'ы' || c == L'э' || 
-           c == L'ю' || c == L'я';
+bool RussianStemmer::is_vowel(char32_t c) {
+    // Заглавные буквы приводятся к строчным: А-Я -> а-я, Ё -> ё
+    if (c >= U'А' && c <= U'Я') c += U'а' - U'А';
+    if (c == U'Ё') c = U'ё';
+    return c == U'а' || c == U'е' || c == U'ё' || c == U'и' || 
+           c == U'о' || c == U'у' || c == U'ы' || c == U'э' || 
+           c == U'ю' || c == U'я';
 }
 
-bool RussianStemmer::ends_with(const std::wstring& word, const std::wstring& ending) const {
-    if (word.length() < ending.length()) return false;
-    return word.substr(word.length() - ending.length()) == ending;
+size_t RussianStemmer::find_vowel(std::string_view word) {
+    for (size_t pos = 0; pos < word.length();) {
+        size_t start = pos;
+        if (is_vowel(utf8::decode(word.data(), word.length(), pos))) {
+            return start;
+        }
+    }
+    return word.length();
 }
 
-int RussianStemmer::count_vowels(const std::wstring& word) const {
-    int count = 0;
-    for (wchar_t c : word) {
-        if (is_vowel(c)) count++;
+bool RussianStemmer::is_exception(std::string_view word) const {
+    auto it = std::lower_bound(exceptions.begin(), exceptions.end(), word,
+                               [](const std::string& a, std::string_view b) { return a < b; });
+    return it != exceptions.end() && *it == word;
+}
+
+size_t RussianStemmer::remove_endings(std::string_view word, size_t chars) const {
+    // Байтовая позиция первой гласной (ищется только при необходимости):
+    // в остатке слова есть гласная, если остаток длиннее этой позиции
+    size_t first_vowel = SuffixTrie::NONE;
+    
+    // Окончание с наивысшим приоритетом, после удаления которого:
+    // 1. Длина не менее 2 символов
+    // 2. Есть хотя бы одна гласная
+    // Длины в бору - в байтах, окончание всегда целое число символов
+    size_t ending = endings.best_match(word, [&](size_t length) {
+        size_t rest = word.length() - length;
+        if (chars - utf8::length(word.substr(rest)) < 2) return false;
+        if (first_vowel == SuffixTrie::NONE) first_vowel = find_vowel(word);
+        return first_vowel < rest;
+    });
+    if (ending == 0) {
+        return word.length();
     }
-    return count;
+    
+    // Дополнительные правила для улучшения качества: суффикс
+    // отсекается, только если после него что-то остается
+    std::string_view candidate = word.substr(0, word.length() - ending);
+    size_t suffix = suffixes.best_match(candidate, [&](size_t length) {
+        return candidate.length() > length;
+    });
+    
+    return candidate.length() - suffix;
 }
 
-std::wstring RussianStemmer::remove_endings(const std::wstring& word) const {
-    std::wstring result = word;
-    
-    for (const auto& ending : endings) {
-        if (ends_with(result, ending)) {
-            std::wstring candidate = result.substr(0, result.length() - ending.length());
-            
-            // Проверяем, что после удаления окончания:
-            // 1. Длина не менее 2 символов
-            // 2. Есть хотя бы одна гласная
-            if (candidate.length() >= 2 && count_vowels(candidate) > 0) {
-                // Дополнительные правила для улучшения качества
-                if (ends_with(candidate, L"ость") && candidate.length() > 4) {
-                    candidate = candidate.substr(0, candidate.length() - 4);
-                }
-                else if (ends_with(candidate, L"тель") && candidate.length() > 4) {
-                    candidate = candidate.substr(0, candidate.length() - 4);
-                }
-                else if (ends_with(candidate, L"ник") && candidate.length() > 3) {
-                    candidate = candidate.substr(0, candidate.length() - 3);
-                }
-                else if (ends_with(candidate, L"ок") && candidate.length() > 2) {
-                    candidate = candidate.substr(0, candidate.length() - 2);
-                }
-                
-                return candidate;
-            }
-        }
+size_t RussianStemmer::stem_length(std::string_view word) const {
+    // Короткие слова не меняются - в кэш их класть незачем
+    if (word.length() <= 3) {
+        return word.length();
+    }
+    
+    size_t length;
+    if (table && table->find(word, length)) {
+        return length;
     }
     
-    return result;
+    bool use_cache = cache && StemCache::cacheable(word);
+    if (use_cache && cache->find(word, length)) {
+        return length;
+    }
+    length = compute_stem_length(word);
+    if (use_cache) {
+        cache->insert(word, length);
+    }
+    return length;
 }
 
-std::wstring RussianStemmer::stem(const std::wstring& word) const {
+size_t RussianStemmer::stem_length(std::wstring_view word) const {
+    std::string utf8_word;
+    for (wchar_t c : word) {
+        utf8::append(utf8_word, static_cast<char32_t>(c));
+    }
+    size_t length = stem_length(std::string_view(utf8_word));
+    return utf8::length(std::string_view(utf8_word).substr(0, length));
+}
+
+void RussianStemmer::stem_batch(const std::string_view* words, size_t count, size_t* lengths) const {
+    for (size_t i = 0; i < count; i++) {
+        lengths[i] = stem_length(words[i]);
+    }
+}
+
+void RussianStemmer::enable_cache(size_t capacity) {
+    if (capacity > 0) {
+        cache = std::make_unique<StemCache>(capacity);
+    } else {
+        cache.reset();
+    }
+}
+
+StemCache::Stats RussianStemmer::cache_stats() const {
+    return cache ? cache->stats() : StemCache::Stats();
+}
+
+bool RussianStemmer::load_table(const std::string& path) {
+    auto loaded = std::make_unique<StemTable>();
+    if (!loaded->open(path) || loaded->algorithm() != static_cast<uint32_t>(algorithm)) {
+        return false;
+    }
+    table = std::move(loaded);
+    return true;
+}
+
+size_t RussianStemmer::table_size() const {
+    return table ? table->size() : 0;
+}
+
+size_t RussianStemmer::compute_stem_length(std::string_view word) const {
+    if (algorithm == Algorithm::SNOWBALL) {
+        return snowball.stem_length(word);
+    }
+    
+    size_t chars = utf8::length(word);
+    
     // Если слово слишком короткое или является исключением
-    if (word.length() <= 3 || exceptions.find(word) != exceptions.end()) {
-        return word;
+    if (chars <= 3 || is_exception(word)) {
+        return word.length();
     }
     
-    std::wstring stemmed = remove_endings(word);
+    size_t length = remove_endings(word, chars);
     
     // Проверяем, что стем не стал слишком коротким
-    if (stemmed.length() < 2) {
-        return word;
+    if (utf8::length(word.substr(0, length)) < 2) {
+        return word.length();
     }
     
-    return stemmed;
+    return length;
 }
 
-std::wstring RussianStemmer::stem(const std::string& utf8_word) const {
-    // Конвертируем UTF-8 в wstring
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    std::wstring wword = converter.from_bytes(utf8_word);
-    
-    // Стемминг
-    std::wstring stemmed = stem(wword);
-    
-    // Возвращаем wstring (или можно конвертировать обратно в UTF-8)
-    return stemmed;
+std::string RussianStemmer::stem(std::string_view utf8_word) const {
+    return std::string(utf8_word.substr(0, stem_length(utf8_word)));
 }
 
-std::vector<std::wstring> RussianStemmer::stem_batch(const std::vector<std::wstring>& words) const {
-    std::vector<std::wstring> result;
-    result.reserve(words.size());
-    
-    for (const auto& word : words) {
-        result.push_back(stem(word));
-    }
-    
-    return result;
+std::wstring RussianStemmer::stem(const std::wstring& word) const {
+    return word.substr(0, stem_length(std::wstring_view(word)));
 }
 
 void RussianStemmer::test() const {
     std::cout << "Тестирование русского стеммера:" << std::endl;
     std::cout << "=================================" << std::endl;
     
-    std::vector<std::wstring> test_words = {
-        L"актёры", L"актёра", L"актёру", L"актёром", L"актёре",
-        L"фильмы", L"фильма", L"фильму", L"фильмом", L"фильме",
-        L"режиссёры", L"режиссёра", L"режиссёру", L"режиссёром",
-        L"голливудский", L"голливудского", L"голливудскому",
-        L"сниматься", L"снимается", L"снимался", L"снимались",
-        L"прекрасный", L"прекрасного", L"прекрасному",
-        L"американский", L"американского", L"американскому"
+    std::vector<std::string> test_words = {
+        "актёры", "актёра", "актёру", "актёром", "актёре",
+        "фильмы", "фильма", "фильму", "фильмом", "фильме",
+        "режиссёры", "режиссёра", "режиссёру", "режиссёром",
+        "голливудский", "голливудского", "голливудскому",
+        "сниматься", "снимается", "снимался", "снимались",
+        "прекрасный", "прекрасного", "прекрасному",
+        "американский", "американского", "американскому"
     };
     
-    // Для вывода wstring в cout нужно конвертировать в UTF-8
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    
     for (const auto& word : test_words) {
-        std::wstring stemmed = stem(word);
-        std::cout << converter.to_bytes(word) << " -> " 
-                  << converter.to_bytes(stemmed) << std::endl;
+        std::string stemmed = stem(word);
+        std::cout << word << " -> " 
+                  << stemmed << std::endl;
     }
     
     // Тест на проблемные случаи
     std::cout << "\nПроблемные случаи:" << std::endl;
     std::cout << "-------------------" << std::endl;
     
-    std::vector<std::pair<std::wstring, std::wstring>> problematic = {
-        {L"мир", L"мир"},           // мир -> мир (правильно)
-        {L"стекло", L"стекл"},      // стекло -> стекл (правильно)
-        {L"писать", L"пис"},        // писать -> пис (упрощенно)
-        {L"бежать", L"беж"},        // бежать -> беж (упрощенно)
-        {L"хороший", L"хорош"},     // хороший -> хорош (правильно)
+    std::vector<std::pair<std::string, std::string>> problematic = {
+        {"мир", "мир"},             // мир -> мир (правильно)
+        {"стекло", "стекл"},        // стекло -> стекл (правильно)
+        {"писать", "пис"},          // писать -> пис (упрощенно)
+        {"бежать", "беж"},          // бежать -> беж (упрощенно)
+        {"хороший", "хорош"},       // хороший -> хорош (правильно)
     };
     
     for (const auto& [word, expected] : problematic) {
-        std::wstring stemmed = stem(word);
-        std::cout << converter.to_bytes(word) << " -> " 
-                  << converter.to_bytes(stemmed) 
-                  << " (ожидалось: " << converter.to_bytes(expected) << ")" 
+        std::string stemmed = stem(word);
+        std::cout << word << " -> " 
+                  << stemmed 
+                  << " (ожидалось: " << expected << ")" 
                   << (stemmed == expected ? " ✓" : " ✗") << std::endl;
     }
 }
\ No newline at end of file
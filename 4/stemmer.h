@@ -2,26 +2,80 @@
 #define STEMMER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
+#include <memory>
+#include "suffix_trie.h"
+#include "snowball_stemmer.h"
+#include "stem_cache.h"
+#include "stem_table.h"
 
+// Стеммер работает прямо с UTF-8: правила применяются к байтам,
+// без перевода слова в wstring. Основа - всегда начало слова,
+// поэтому результат - длина основы в байтах.
 class RussianStemmer {
+public:
+    // Значения записываются в файл таблицы основ (StemTable) - не менять
+    enum class Algorithm {
+        SIMPLE = 0,    // Список окончаний и несколько суффиксов
+        SNOWBALL = 1   // Snowball (области RV/R2, группы окончаний)
+    };
+    
 private:
-    std::unordered_set<std::wstring> exceptions;
-    std::vector<std::wstring> endings;
+    Algorithm algorithm;
+    SnowballStemmer snowball;
+    
+    std::vector<std::string> exceptions;  // Отсортированы: поиск без создания строк
+    // Окончания и дополнительные суффиксы в UTF-8; id - приоритет в исходном списке
+    SuffixTrie endings;
+    SuffixTrie suffixes;
     
-    bool is_vowel(wchar_t c) const;
-    bool ends_with(const std::wstring& word, const std::wstring& ending) const;
-    int count_vowels(const std::wstring& word) const;
-    std::wstring remove_endings(const std::wstring& word) const;
+    static bool is_vowel(char32_t c);
+    // Байтовая позиция первой гласной (длина слова, если гласных нет)
+    static size_t find_vowel(std::string_view word);
+    bool is_exception(std::string_view word) const;
+    // Длина слова (в байтах) после отсечения окончания; chars - число символов
+    size_t remove_endings(std::string_view word, size_t chars) const;
+    size_t compute_stem_length(std::string_view word) const;
+    
+    // Необязательный кэш основ (см. enable_cache)
+    std::unique_ptr<StemCache> cache;
+    // Необязательная заранее посчитанная таблица основ (см. load_table)
+    std::unique_ptr<StemTable> table;
     
 public:
-    RussianStemmer();
+    explicit RussianStemmer(Algorithm algorithm = Algorithm::SIMPLE);
     
-    std::wstring stem(const std::wstring& word) const;
-    std::wstring stem(const std::string& utf8_word) const;
+    // Длина основы слова в UTF-8, в байтах. Без кэша не выделяет память:
+    // можно вызывать на каждый токен, а затем укоротить токен на месте
+    // (token.resize(stem_length(token))) или взять token.substr(0, ...).
+    // Потокобезопасен, в том числе с включенным кэшем
+    size_t stem_length(std::string_view word) const;
+    // То же для wide-строки, длина в символах (через перевод в UTF-8)
+    size_t stem_length(std::wstring_view word) const;
     
-    std::vector<std::wstring> stem_batch(const std::vector<std::wstring>& words) const;
+    // Пакетный стемминг в буфер вызывающего: lengths[i] - длина основы
+    // words[i] в байтах, сама основа - words[i].substr(0, lengths[i])
+    void stem_batch(const std::string_view* words, size_t count, size_t* lengths) const;
+    
+    // Включает кэш основ на capacity слов (0 - выключает).
+    // Вызывать до начала стемминга, не параллельно с ним
+    void enable_cache(size_t capacity);
+    // Счетчики попаданий/промахов кэша (нули, если кэш выключен)
+    StemCache::Stats cache_stats() const;
+    
+    // Подключает таблицу основ (build_stem_table): слова из нее
+    // не стеммируются, а ищутся в отображенном в память файле.
+    // false, если файл не открылся или посчитан другим алгоритмом.
+    // Вызывать до начала стемминга, не параллельно с ним
+    bool load_table(const std::string& path);
+    // Число слов в подключенной таблице (0, если таблицы нет)
+    size_t table_size() const;
+    
+    Algorithm get_algorithm() const { return algorithm; }
+    
+    std::string stem(std::string_view utf8_word) const;
+    std::wstring stem(const std::wstring& word) const;
     
     void test() const;
 };
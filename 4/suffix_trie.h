@@ -0,0 +1,111 @@
+#ifndef SUFFIX_TRIE_H
+#define SUFFIX_TRIE_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Набор окончаний (UTF-8) в виде бора по перевернутым строкам: один
+// проход с конца слова находит все окончания, которыми слово
+// заканчивается, за O(длины самого длинного окончания) вместо
+// сравнения с каждым. Каждому окончанию приписан номер (id) -
+// например, его приоритет в исходном списке.
+//
+// Бор хранится как конечный автомат по байтам: байты, встречающиеся
+// в окончаниях, пронумерованы классами, переходы - плотная таблица
+// "состояние x класс", так что шаг автомата - два обращения к массиву.
+class SuffixTrie {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+private:
+    uint8_t byte_class[256];            // 0 - байт не встречается в окончаниях
+    size_t class_count;                 // Включая класс 0
+    std::vector<uint32_t> transitions;  // [состояние * class_count + класс], 0 - нет перехода
+    std::vector<uint32_t> ids;          // [состояние], NONE - окончание здесь не заканчивается
+
+    uint32_t& next_state(uint32_t state, uint8_t cls) {
+        return transitions[state * class_count + cls];
+    }
+
+    uint8_t add_class(unsigned char byte) {
+        // Новый столбец таблицы переходов: перекладываем таблицу
+        // (только при построении)
+        std::vector<uint32_t> widened(ids.size() * (class_count + 1), 0);
+        for (size_t state = 0; state < ids.size(); state++) {
+            for (size_t cls = 0; cls < class_count; cls++) {
+                widened[state * (class_count + 1) + cls] = transitions[state * class_count + cls];
+            }
+        }
+        transitions.swap(widened);
+        byte_class[byte] = static_cast<uint8_t>(class_count);
+        return static_cast<uint8_t>(class_count++);
+    }
+
+public:
+    SuffixTrie() : byte_class(), class_count(1), transitions(1, 0), ids(1, NONE) {}
+
+    // При повторном добавлении остается меньший id
+    void insert(std::string_view suffix, uint32_t id) {
+        uint32_t state = 0;
+        for (size_t i = suffix.size(); i-- > 0;) {
+            unsigned char byte = static_cast<unsigned char>(suffix[i]);
+            uint8_t cls = byte_class[byte] != 0 ? byte_class[byte] : add_class(byte);
+            if (next_state(state, cls) == 0) {
+                uint32_t created = static_cast<uint32_t>(ids.size());
+                ids.push_back(NONE);
+                transitions.resize(ids.size() * class_count, 0);
+                next_state(state, cls) = created;
+            }
+            state = next_state(state, cls);
+        }
+        if (id < ids[state]) {
+            ids[state] = id;
+        }
+    }
+
+    // callback(id, length) для каждого окончания слова, от коротких к длинным
+    template <typename Callback>
+    void match(std::string_view word, Callback&& callback) const {
+        uint32_t state = 0;
+        for (size_t i = word.size(); i-- > 0;) {
+            uint8_t cls = byte_class[static_cast<unsigned char>(word[i])];
+            state = transitions[state * class_count + cls];
+            if (state == 0) {
+                return;
+            }
+            if (ids[state] != NONE) {
+                callback(ids[state], word.size() - i);
+            }
+        }
+    }
+
+    // Самое длинное окончание слова: его длина (0, если нет) и id
+    size_t longest_match(std::string_view word, uint32_t& id) const {
+        size_t best_length = 0;
+        match(word, [&](uint32_t match_id, size_t length) {
+            best_length = length;
+            id = match_id;
+        });
+        return best_length;
+    }
+
+    // Окончание с наименьшим id среди тех, для которых accept(length)
+    // истинно: то же, что перебор списка по приоритету с первым подходящим.
+    // Возвращает длину окончания или 0, если подходящего нет
+    template <typename Accept>
+    size_t best_match(std::string_view word, Accept&& accept) const {
+        uint32_t best_id = NONE;
+        size_t best_length = 0;
+        match(word, [&](uint32_t id, size_t length) {
+            if (id < best_id && accept(length)) {
+                best_id = id;
+                best_length = length;
+            }
+        });
+        return best_length;
+    }
+};
+
+#endif
\ No newline at end of file
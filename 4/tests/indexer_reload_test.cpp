@@ -0,0 +1,113 @@
+// Повторная загрузка двоичного индекса: неудачная загрузка (нет файла,
+// обрезан, чужая сигнатура или версия) не должна трогать уже
+// загруженный индекс - его шарды читают данные прямо из отображения
+// файла. После каждой неудачной попытки те же запросы должны давать
+// те же ответы, удачная загрузка подменяет индекс целиком.
+//
+// Запуск: indexer_reload_test (через ctest). Корпус из нескольких
+// документов создается во временном каталоге и удаляется после теста.
+
+#define INDEXER_NO_MAIN
+#include "../indexer_with_stemming.cpp"
+
+namespace {
+
+const char* const DOCUMENTS[] = {
+    "Американский актёр сыграл главную роль в новом фильме известного режиссёра.",
+    "Режиссёр снял фильм о жизни актёров, актёры играли самих себя.",
+    "Фильмы этого режиссёра часто получают премии на кинофестивалях.",
+    "Молодая актриса впервые снялась в кино, фильм вышел весной.",
+    "Критики назвали фильм лучшим фильмом года, а актёра - открытием."
+};
+
+const char* const QUERIES[] = {
+    "фильм",
+    "актёр режиссёр",
+    "премии",
+    "\"американский актёр\"",
+    "актёр NEAR/3 фильм"
+};
+
+std::vector<std::vector<int>> run_queries(IndexerWithStemming& indexer) {
+    std::vector<std::vector<int>> results;
+    for (const char* query : QUERIES) {
+        results.push_back(IndexerWithStemming::is_positional_query(query)
+                              ? indexer.search_positional(query)
+                              : indexer.search_utf8(query));
+    }
+    return results;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const fs::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(content.data(), content.size());
+}
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "indexer_reload_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "corpus");
+    for (size_t i = 0; i < std::size(DOCUMENTS); i++) {
+        write_file(dir / "corpus" / ("doc" + std::to_string(i) + ".txt"), DOCUMENTS[i]);
+    }
+
+    bool ok = true;
+    auto check = [&](bool condition, const std::string& what) {
+        if (!condition) {
+            std::cout << "ОШИБКА: " << what << std::endl;
+            ok = false;
+        }
+    };
+
+    std::string good_path = (dir / "index.bin").string();
+    std::vector<std::vector<int>> expected;
+    {
+        IndexerWithStemming builder(2);
+        builder.index_directory((dir / "corpus").string());
+        expected = run_queries(builder);
+        check(builder.save_binary_index(good_path), "не удалось сохранить индекс");
+    }
+    check(!expected[0].empty() && !expected[3].empty(), "запросы к построенному индексу ничего не нашли");
+
+    IndexerWithStemming indexer(2);
+    check(indexer.load_binary_index(good_path), "не загрузился только что сохраненный индекс");
+    check(run_queries(indexer) == expected, "загруженный индекс отвечает не так, как построенный");
+
+    // Поврежденные варианты файла
+    std::string good = read_file(good_path);
+    std::string bad_magic = good;
+    bad_magic[0] = 'X';
+    std::string bad_version = good;
+    bad_version[4] ^= 0x7F;  // version - сразу за сигнатурой
+    std::vector<std::pair<std::string, std::string>> corrupted = {
+        {"обрезанный до заголовка", good.substr(0, 16)},
+        {"обрезанный наполовину", good.substr(0, good.size() / 2)},
+        {"с чужой сигнатурой", bad_magic},
+        {"другой версии", bad_version},
+        {"пустой", ""}
+    };
+    std::string bad_path = (dir / "bad.bin").string();
+    for (const auto& [name, content] : corrupted) {
+        write_file(bad_path, content);
+        check(!indexer.load_binary_index(bad_path), "загрузился файл " + name);
+        check(run_queries(indexer) == expected, "после файла " + name + " индекс отвечает иначе");
+    }
+    check(!indexer.load_binary_index((dir / "missing.bin").string()), "загрузился несуществующий файл");
+    check(run_queries(indexer) == expected, "после несуществующего файла индекс отвечает иначе");
+
+    // Удачная повторная загрузка подменяет отображение
+    check(indexer.load_binary_index(good_path), "не загрузился индекс повторно");
+    check(run_queries(indexer) == expected, "повторно загруженный индекс отвечает иначе");
+    check(indexer.get_document_count() == std::size(DOCUMENTS), "неверное число документов");
+
+    fs::remove_all(dir);
+    std::cout << (ok ? "Все проверки пройдены" : "Есть ошибки") << std::endl;
+    return ok ? 0 : 1;
+}
\ No newline at end of file
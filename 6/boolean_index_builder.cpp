@@ -6,8 +6,9 @@
 #include <algorithm>
 #include <chrono>
 #include <cstring>
-#include <cctype>
 #include <filesystem>
+#include "token_scanner.h"
+#include "mapped_file.h"
 
 namespace fs = std::filesystem;
 
@@ -259,54 +260,27 @@ private:
         Document& doc = documents[doc_id];
         
         try {
-            // Чтение файла
-            std::ifstream file(doc.path, std::ios::binary);
-            if (!file.is_open()) {
+            // Файл отображается в память и токенизируется без копирования
+            MappedFile file;
+            if (!file.open(doc.path)) {
                 return false;
             }
             
-            // Определение размера файла
-            file.seekg(0, std::ios::end);
-            size_t file_size = file.tellg();
-            file.seekg(0, std::ios::beg);
+            stats.total_bytes += file.get_size();
             
-            // Чтение содержимого
-            std::string content(file_size, '\0');
-            file.read(&content[0], file_size);
-            file.close();
-            
-            stats.total_bytes += file_size;
-            
-            // Токенизация
+            // Токенизация общим токенизатором (tokenizer_core)
             std::unordered_map<std::string, uint32_t> term_counts;  // Термы и их частоты в документе
             
-            std::string current_token;
-            bool in_token = false;
-            
-            for (char c : content) {
-                if (is_valid_token_char(c)) {
-                    // Добавляем символ к текущему токену (приводим к нижнему регистру)
-                    current_token += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-                    in_token = true;
-                } else if (in_token) {
-                    // Завершаем токен
-                    if (current_token.length() > 1) {  // Игнорируем однобуквенные токены
-                        term_counts[current_token]++;
-                        stats.total_tokens++;
-                        doc.token_count++;
-                    }
-                    current_token.clear();
-                    in_token = false;
+            TokenScanner scanner(file.view());
+            std::string_view token;
+            while (scanner.next(token)) {
+                if (scanner.token_length() > 1) {  // Игнорируем однобуквенные токены
+                    term_counts[std::string(token)]++;
+                    stats.total_tokens++;
+                    doc.token_count++;
                 }
             }
             
-            // Последний токен
-            if (in_token && current_token.length() > 1) {
-                term_counts[current_token]++;
-                stats.total_tokens++;
-                doc.token_count++;
-            }
-            
             // Добавление термов в обратный индекс
             for (const auto& term_pair : term_counts) {
                 const std::string& term = term_pair.first;
@@ -325,31 +299,6 @@ private:
         }
     }
     
-    // Проверка, является ли символ допустимым в токене
-    bool is_valid_token_char(char c) const {
-        // Русские буквы
-        if ((c >= 'а' && c <= 'я') || (c >= 'А' && c <= 'Я') || c == 'ё' || c == 'Ё') {
-            return true;
-        }
-        
-        // Английские буквы
-        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
-            return true;
-        }
-        
-        // Цифры
-        if (c >= '0' && c <= '9') {
-            return true;
-        }
-        
-        // Некоторые специальные символы, которые могут быть частью слова
-        if (c == '-' || c == '\'' || c == '&') {
-            return true;
-        }
-        
-        return false;
-    }
-    
     // Подготовка словаря термов (сортировка)
     void prepare_term_dictionary() {
         sorted_terms.reserve(term_index.size());
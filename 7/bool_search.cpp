@@ -7,6 +7,8 @@
 #include <vector>
 #include <filesystem>
 #include <chrono>
+#include "token_scanner.h"
+#include "mapped_file.h"
 
 namespace fs = std::filesystem;
 using namespace std;
@@ -20,18 +22,15 @@ string trim(string s) {
     return s;
 }
 
-vector<string> tokenize(const string& text) {
+// Токенизация общим токенизатором (tokenizer_core) - одинаково
+// для документов и для слов запроса
+vector<string> tokenize(string_view text) {
     vector<string> tokens;
-    string token;
-    for (char c : text) {
-        if (isalnum(c) || c >= 'а' && c <= 'я' || c >= 'А' && c <= 'Я') {
-            token += tolower(c);
-        } else if (!token.empty()) {
-            tokens.push_back(token);
-            token.clear();
-        }
+    TokenScanner scanner(text);
+    string_view token;
+    while (scanner.next(token)) {
+        tokens.emplace_back(token);
     }
-    if (!token.empty()) tokens.push_back(token);
     return tokens;
 }
 
@@ -39,10 +38,14 @@ void build_index(const string& dir) {
     int id = 1;
     for (const auto& entry : fs::directory_iterator(dir)) {
         if (entry.path().extension() == ".txt") {
-            ifstream f(entry.path());
-            string text((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
-            for (const string& word : tokenize(text)) {
-                idx[word].insert(id);
+            MappedFile file;
+            if (!file.open(entry.path().string())) {
+                continue;
+            }
+            TokenScanner scanner(file.view());
+            string_view word;
+            while (scanner.next(word)) {
+                idx[string(word)].insert(id);
             }
             docs[id] = entry.path().string();
             all_docs.insert(id);
@@ -78,7 +81,8 @@ unordered_set<int> eval(const string& expr) {
             // Нужно обработать следующий терм
             if (i + 1 < expr.size()) {
                 // Если после ! идет слово
-                if (isalnum(expr[i+1]) || expr[i+1] == '(') {
+                if (isalnum(static_cast<unsigned char>(expr[i+1])) ||
+                    static_cast<unsigned char>(expr[i+1]) >= 0x80 || expr[i+1] == '(') {
                     // Пропускаем ! и обрабатываем следующий терм
                     continue;
                 }
@@ -86,17 +90,32 @@ unordered_set<int> eval(const string& expr) {
             op = "!";
         }
         else {
-            string word;
-            while (i < expr.size() && (isalnum(expr[i]) || expr[i] >= 'а' && expr[i] <= 'я' || expr[i] >= 'А' && expr[i] <= 'Я')) {
-                word += tolower(expr[i]);
-                i++;
+            // Операнд - все до пробела, скобки или оператора; разбирается
+            // тем же токенизатором, что и документы. Если в операнде
+            // несколько токенов (например, "a/b"), они объединяются по И
+            size_t j = i;
+            while (j < expr.size() && expr[j] != ' ' && expr[j] != '(' && expr[j] != ')' &&
+                   expr.compare(j, 2, "&&") != 0 && expr.compare(j, 2, "||") != 0) {
+                j++;
             }
-            i--;
+            vector<string> words = tokenize(string_view(expr).substr(i, j - i));
+            i = j - 1;
             
-            if (!word.empty()) {
+            if (!words.empty()) {
                 unordered_set<int> res;
-                if (idx.count(word)) {
-                    res = idx[word];
+                if (idx.count(words[0])) {
+                    res = idx[words[0]];
+                }
+                for (size_t k = 1; k < words.size(); k++) {
+                    unordered_set<int> both;
+                    if (idx.count(words[k])) {
+                        for (int x : res) {
+                            if (idx[words[k]].count(x)) {
+                                both.insert(x);
+                            }
+                        }
+                    }
+                    res = both;
                 }
                 st.push(res);
             }